@@ -0,0 +1,689 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#include "Archive.hpp"
+
+#include "oatpp/data/stream/FileStream.hpp"
+#include "oatpp/base/Log.hpp"
+
+#include <cstring>
+#include <cstdio>
+
+namespace oatpp { namespace zlib {
+
+namespace {
+
+  constexpr v_uint16 ZIP_FLAGS = 0x0008 /* data descriptor */ | 0x0800 /* UTF-8 names */;
+  constexpr v_uint16 ZIP_METHOD_DEFLATE = 8;
+  constexpr v_uint16 ZIP_VERSION = 20;
+  constexpr v_uint16 ZIP_VERSION_ZIP64 = 45;
+  constexpr v_uint16 ZIP_VERSION_MADE_BY = (3 /* unix */ << 8) | ZIP_VERSION_ZIP64;
+  constexpr v_uint32 ZIP_EXTERNAL_ATTRIBUTES = 0100644u << 16;
+  constexpr v_uint32 ZIP_MAX_32 = 0xFFFFFFFF;
+  constexpr v_uint16 ZIP_MAX_16 = 0xFFFF;
+
+  /* entries of known size below this limit get 32-bit sizes - leaves room for deflate expansion */
+  constexpr v_int64 ZIP64_THRESHOLD = 0xFF000000;
+
+  constexpr v_int64 TAR_BLOCK_SIZE = 512;
+  constexpr v_int64 TAR_MAX_OCTAL = 077777777777;
+
+  void putU16(std::string& out, v_uint16 value) {
+    out.push_back((char) (value & 0xFF));
+    out.push_back((char) (value >> 8));
+  }
+
+  void putU32(std::string& out, v_uint32 value) {
+    putU16(out, (v_uint16) (value & 0xFFFF));
+    putU16(out, (v_uint16) (value >> 16));
+  }
+
+  void putU64(std::string& out, v_uint64 value) {
+    putU32(out, (v_uint32) (value & 0xFFFFFFFF));
+    putU32(out, (v_uint32) (value >> 32));
+  }
+
+  void toDosTime(v_int64 time, v_uint16& dosTime, v_uint16& dosDate) {
+
+    if(time < 315532800 /* 1980-01-01 */) {
+      dosTime = 0;
+      dosDate = (1 << 5) | 1;
+      return;
+    }
+
+    v_int64 seconds = time % 86400;
+
+    /* civil date from days since epoch */
+    v_int64 days = time / 86400 + 719468;
+    v_int64 era = days / 146097;
+    v_int64 doe = days - era * 146097;
+    v_int64 yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    v_int64 doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    v_int64 mp = (5 * doy + 2) / 153;
+    v_int64 day = doy - (153 * mp + 2) / 5 + 1;
+    v_int64 month = mp < 10 ? mp + 3 : mp - 9;
+    v_int64 year = yoe + era * 400 + (month <= 2 ? 1 : 0);
+
+    if(year > 2107) {
+      year = 2107;
+    }
+
+    dosTime = (v_uint16) (((seconds / 3600) << 11) | (((seconds / 60) % 60) << 5) | ((seconds % 60) / 2));
+    dosDate = (v_uint16) (((year - 1980) << 9) | (month << 5) | day);
+
+  }
+
+  void writeOctal(char* field, v_int32 width, v_uint64 value) {
+    for(v_int32 i = width - 2; i >= 0; i --) {
+      field[i] = (char) ('0' + (value & 7));
+      value >>= 3;
+    }
+    field[width - 1] = '\0';
+  }
+
+  void appendTarHeader(std::string& out, const std::string& name, const std::string& prefix,
+                       v_int64 size, v_int64 modificationTime, char type)
+  {
+
+    char header[TAR_BLOCK_SIZE];
+    std::memset(header, 0, TAR_BLOCK_SIZE);
+
+    std::memcpy(header, name.data(), std::min<size_t>(name.size(), 100));
+    writeOctal(header + 100, 8, 0644);
+    writeOctal(header + 108, 8, 0);
+    writeOctal(header + 116, 8, 0);
+    writeOctal(header + 124, 12, size <= TAR_MAX_OCTAL ? size : 0);
+    writeOctal(header + 136, 12, modificationTime < 0 ? 0 : std::min<v_int64>(modificationTime, TAR_MAX_OCTAL));
+    std::memset(header + 148, ' ', 8);
+    header[156] = type;
+    std::memcpy(header + 257, "ustar", 6);
+    std::memcpy(header + 263, "00", 2);
+    std::memcpy(header + 345, prefix.data(), std::min<size_t>(prefix.size(), 155));
+
+    v_uint32 checksum = 0;
+    for(v_int32 i = 0; i < TAR_BLOCK_SIZE; i ++) {
+      checksum += (v_uint8) header[i];
+    }
+    writeOctal(header + 148, 7, checksum);
+    header[155] = ' ';
+
+    out.append(header, TAR_BLOCK_SIZE);
+
+  }
+
+  std::string makePaxRecord(const std::string& key, const std::string& value) {
+    /* "<length> <key>=<value>\n" - length includes its own digits */
+    std::string content = " " + key + "=" + value + "\n";
+    size_t size = content.size() + 1;
+    while(true) {
+      size_t total = content.size() + std::to_string(size).size();
+      if(total == size) {
+        break;
+      }
+      size = total;
+    }
+    return std::to_string(size) + content;
+  }
+
+  v_int64 getFileSize(std::FILE* file) {
+#if defined(WIN32) || defined(_WIN32)
+    _fseeki64(file, 0, SEEK_END);
+    v_int64 size = _ftelli64(file);
+    _fseeki64(file, 0, SEEK_SET);
+#else
+    fseeko(file, 0, SEEK_END);
+    v_int64 size = ftello(file);
+    fseeko(file, 0, SEEK_SET);
+#endif
+    return size;
+  }
+
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ArchiveEntry
+
+ArchiveEntry ArchiveEntry::createFromStream(const oatpp::String& name,
+                                            const std::shared_ptr<data::stream::ReadCallback>& stream,
+                                            v_int64 size,
+                                            v_int64 modificationTime)
+{
+  ArchiveEntry entry;
+  entry.name = name;
+  entry.stream = stream;
+  entry.size = size;
+  entry.modificationTime = modificationTime;
+  return entry;
+}
+
+ArchiveEntry ArchiveEntry::createFromFile(const oatpp::String& name,
+                                          const oatpp::String& filename,
+                                          v_int64 modificationTime)
+{
+  ArchiveEntry entry;
+  entry.name = name;
+  entry.filename = filename;
+  entry.modificationTime = modificationTime;
+  return entry;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// StreamingArchive
+
+StreamingArchive::StreamingArchive(ArchiveFormat format,
+                                   std::vector<ArchiveEntry> entries,
+                                   v_int32 compressionLevel,
+                                   v_buff_size bufferSize)
+  : m_format(format)
+  , m_entries(std::move(entries))
+  , m_compressionLevel(compressionLevel)
+  , m_bufferSize(bufferSize)
+  , m_readBuffer(new v_char8[bufferSize])
+  , m_state(STATE_ENTRY_START)
+  , m_entryIndex(0)
+  , m_entrySize(-1)
+  , m_entryLeft(0)
+  , m_entryRead(0)
+  , m_entryCrc(0)
+  , m_entryDataOffset(0)
+  , m_entryZip64(false)
+  , m_offset(0)
+  , m_error(0)
+{
+
+  for(auto& entry : m_entries) {
+
+    if(!entry.name || entry.name->empty()) {
+      throw std::runtime_error("[oatpp::zlib::StreamingArchive::StreamingArchive()]: Error. Entry name is empty.");
+    }
+
+    if(!entry.stream && !entry.filename) {
+      throw std::runtime_error("[oatpp::zlib::StreamingArchive::StreamingArchive()]: Error. Entry has neither stream nor file.");
+    }
+
+    if(m_format == ArchiveFormat::ZIP && entry.name->size() > ZIP_MAX_16) {
+      throw std::runtime_error("[oatpp::zlib::StreamingArchive::StreamingArchive()]: Error. Entry name is too long.");
+    }
+
+    if(m_format == ArchiveFormat::TAR_GZ && entry.stream && entry.size < 0) {
+      throw std::runtime_error("[oatpp::zlib::StreamingArchive::StreamingArchive()]: Error. Tar entry size must be known.");
+    }
+
+  }
+
+  if(m_format == ArchiveFormat::TAR_GZ) {
+    m_encoder = std::make_shared<DeflateEncoder>(m_bufferSize, Format::GZIP, m_compressionLevel);
+  }
+
+  m_inData.set(m_readBuffer.get(), 0);
+
+}
+
+bool StreamingArchive::openEntry() {
+
+  auto& entry = m_entries[m_entryIndex];
+
+  m_entrySize = entry.size;
+
+  if(entry.stream) {
+    m_entryStream = entry.stream;
+  } else {
+    try {
+      auto file = std::make_shared<data::stream::FileInputStream>(entry.filename->c_str());
+      m_entrySize = getFileSize(file->getFile());
+      m_entryStream = file;
+    } catch (std::runtime_error& e) {
+      OATPP_LOGe("[oatpp::zlib::StreamingArchive::openEntry()]", "Error. Can't open file '{}'.", entry.filename)
+      return false;
+    }
+  }
+
+  m_entryLeft = m_entrySize;
+  m_entryRead = 0;
+  m_entryCrc = crc32(0, Z_NULL, 0);
+
+  return true;
+
+}
+
+v_io_size StreamingArchive::readEntry(v_buff_size count) {
+  auto res = m_entryStream->readSimple(m_readBuffer.get(), count);
+  if(res > 0) {
+    m_entryRead += res;
+  }
+  return res;
+}
+
+void StreamingArchive::writeZipLocalHeader() {
+
+  auto& entry = m_entries[m_entryIndex];
+
+  ZipRecord record;
+  record.name = *entry.name;
+  record.crc = 0;
+  record.compressedSize = 0;
+  record.size = 0;
+  record.offset = m_offset;
+  record.zip64 = m_entryZip64;
+  toDosTime(entry.modificationTime, record.dosTime, record.dosDate);
+
+  m_pending.clear();
+  putU32(m_pending, 0x04034b50);
+  putU16(m_pending, record.zip64 ? ZIP_VERSION_ZIP64 : ZIP_VERSION);
+  putU16(m_pending, ZIP_FLAGS);
+  putU16(m_pending, ZIP_METHOD_DEFLATE);
+  putU16(m_pending, record.dosTime);
+  putU16(m_pending, record.dosDate);
+  putU32(m_pending, 0); // crc and sizes are in the data descriptor
+  putU32(m_pending, record.zip64 ? ZIP_MAX_32 : 0);
+  putU32(m_pending, record.zip64 ? ZIP_MAX_32 : 0);
+  putU16(m_pending, (v_uint16) record.name.size());
+  putU16(m_pending, record.zip64 ? 20 : 0);
+  m_pending.append(record.name);
+
+  if(record.zip64) {
+    /* ZIP64 extra field tells readers that the data descriptor has 64-bit sizes */
+    putU16(m_pending, 0x0001);
+    putU16(m_pending, 16);
+    putU64(m_pending, 0);
+    putU64(m_pending, 0);
+  }
+
+  m_records.push_back(std::move(record));
+  m_outData.set(m_pending.data(), m_pending.size());
+
+}
+
+void StreamingArchive::writeZipDescriptor() {
+
+  auto& record = m_records.back();
+  record.crc = m_entryCrc;
+  record.size = m_entryRead;
+  record.compressedSize = m_offset - m_entryDataOffset;
+
+  m_pending.clear();
+  putU32(m_pending, 0x08074b50);
+  putU32(m_pending, record.crc);
+  if(record.zip64) {
+    putU64(m_pending, record.compressedSize);
+    putU64(m_pending, record.size);
+  } else {
+    putU32(m_pending, (v_uint32) record.compressedSize);
+    putU32(m_pending, (v_uint32) record.size);
+  }
+
+  m_outData.set(m_pending.data(), m_pending.size());
+
+}
+
+void StreamingArchive::writeZipCentralDirectory() {
+
+  m_pending.clear();
+
+  v_uint64 directoryOffset = m_offset;
+
+  for(auto& record : m_records) {
+
+    bool zip64 = record.zip64 || record.size >= ZIP_MAX_32 || record.compressedSize >= ZIP_MAX_32 || record.offset >= ZIP_MAX_32;
+
+    putU32(m_pending, 0x02014b50);
+    putU16(m_pending, ZIP_VERSION_MADE_BY);
+    putU16(m_pending, zip64 ? ZIP_VERSION_ZIP64 : ZIP_VERSION);
+    putU16(m_pending, ZIP_FLAGS);
+    putU16(m_pending, ZIP_METHOD_DEFLATE);
+    putU16(m_pending, record.dosTime);
+    putU16(m_pending, record.dosDate);
+    putU32(m_pending, record.crc);
+    putU32(m_pending, zip64 ? ZIP_MAX_32 : (v_uint32) record.compressedSize);
+    putU32(m_pending, zip64 ? ZIP_MAX_32 : (v_uint32) record.size);
+    putU16(m_pending, (v_uint16) record.name.size());
+    putU16(m_pending, zip64 ? 28 : 0);
+    putU16(m_pending, 0); // comment
+    putU16(m_pending, 0); // disk number
+    putU16(m_pending, 0); // internal attributes
+    putU32(m_pending, ZIP_EXTERNAL_ATTRIBUTES);
+    putU32(m_pending, zip64 ? ZIP_MAX_32 : (v_uint32) record.offset);
+    m_pending.append(record.name);
+
+    if(zip64) {
+      putU16(m_pending, 0x0001);
+      putU16(m_pending, 24);
+      putU64(m_pending, record.size);
+      putU64(m_pending, record.compressedSize);
+      putU64(m_pending, record.offset);
+    }
+
+  }
+
+  v_uint64 directorySize = m_pending.size();
+  v_uint64 count = m_records.size();
+  bool zip64 = count >= ZIP_MAX_16 || directorySize >= ZIP_MAX_32 || directoryOffset >= ZIP_MAX_32;
+
+  if(zip64) {
+
+    /* ZIP64 end of central directory record */
+    putU32(m_pending, 0x06064b50);
+    putU64(m_pending, 44);
+    putU16(m_pending, ZIP_VERSION_MADE_BY);
+    putU16(m_pending, ZIP_VERSION_ZIP64);
+    putU32(m_pending, 0);
+    putU32(m_pending, 0);
+    putU64(m_pending, count);
+    putU64(m_pending, count);
+    putU64(m_pending, directorySize);
+    putU64(m_pending, directoryOffset);
+
+    /* ZIP64 end of central directory locator */
+    putU32(m_pending, 0x07064b50);
+    putU32(m_pending, 0);
+    putU64(m_pending, directoryOffset + directorySize);
+    putU32(m_pending, 1);
+
+  }
+
+  putU32(m_pending, 0x06054b50);
+  putU16(m_pending, 0);
+  putU16(m_pending, 0);
+  putU16(m_pending, zip64 ? ZIP_MAX_16 : (v_uint16) count);
+  putU16(m_pending, zip64 ? ZIP_MAX_16 : (v_uint16) count);
+  putU32(m_pending, zip64 ? ZIP_MAX_32 : (v_uint32) directorySize);
+  putU32(m_pending, zip64 ? ZIP_MAX_32 : (v_uint32) directoryOffset);
+  putU16(m_pending, 0);
+
+  m_outData.set(m_pending.data(), m_pending.size());
+
+}
+
+void StreamingArchive::writeTarHeader() {
+
+  auto& entry = m_entries[m_entryIndex];
+  const std::string& name = *entry.name;
+
+  std::string headerName = name;
+  std::string prefix;
+  std::string pax;
+
+  if(name.size() > 100) {
+
+    /* ustar - split the path into prefix and name */
+    bool split = false;
+    for(auto pos = name.find('/'); pos != std::string::npos && pos <= 155; pos = name.find('/', pos + 1)) {
+      size_t rest = name.size() - pos - 1;
+      if(rest > 0 && rest <= 100) {
+        prefix = name.substr(0, pos);
+        headerName = name.substr(pos + 1);
+        split = true;
+        break;
+      }
+    }
+
+    if(!split) {
+      pax += makePaxRecord("path", name);
+      headerName = name.substr(0, 100);
+    }
+
+  }
+
+  if(m_entrySize > TAR_MAX_OCTAL) {
+    pax += makePaxRecord("size", std::to_string(m_entrySize));
+  }
+
+  m_tarPending.clear();
+
+  if(!pax.empty()) {
+    appendTarHeader(m_tarPending, "././@PaxHeader", "", (v_int64) pax.size(), entry.modificationTime, 'x');
+    m_tarPending.append(pax);
+    m_tarPending.append((TAR_BLOCK_SIZE - pax.size() % TAR_BLOCK_SIZE) % TAR_BLOCK_SIZE, '\0');
+  }
+
+  appendTarHeader(m_tarPending, headerName, prefix, m_entrySize, entry.modificationTime, '0');
+
+  m_inData.set(m_tarPending.data(), m_tarPending.size());
+
+}
+
+v_io_size StreamingArchive::stepZip() {
+
+  switch(m_state) {
+
+    case STATE_ENTRY_START: {
+
+      if(m_entryIndex >= m_entries.size()) {
+        writeZipCentralDirectory();
+        m_state = STATE_DONE;
+        return 0;
+      }
+
+      if(!openEntry()) {
+        return IOError::BROKEN_PIPE;
+      }
+
+      m_entryZip64 = m_entrySize < 0 || m_entrySize >= ZIP64_THRESHOLD;
+      writeZipLocalHeader();
+      m_entryDataOffset = m_offset + m_pending.size();
+
+      m_encoder = std::make_shared<DeflateEncoder>(m_bufferSize, Format::RAW, m_compressionLevel);
+      m_inData.set(m_readBuffer.get(), 0);
+      m_state = STATE_ENTRY_DATA;
+
+      return 0;
+
+    }
+
+    case STATE_ENTRY_DATA: {
+
+      if(m_inData.bytesLeft == 0 && m_inData.currBufferPtr != nullptr) {
+        auto res = readEntry(m_bufferSize);
+        if(res > 0) {
+          m_entryCrc = crc32(m_entryCrc, m_readBuffer.get(), (uInt) res);
+          m_inData.set(m_readBuffer.get(), res);
+        } else if(res == 0) {
+          m_inData.set(nullptr, 0);
+        } else {
+          return res;
+        }
+      }
+
+      auto res = m_encoder->iterate(m_inData, m_outData);
+
+      switch(res) {
+
+        case DeflateEncoder::Error::PROVIDE_DATA_IN:
+        case DeflateEncoder::Error::FLUSH_DATA_OUT:
+          return 0;
+
+        case DeflateEncoder::Error::FINISHED:
+
+          if(m_entrySize >= 0 && m_entryRead != (v_uint64) m_entrySize) {
+            OATPP_LOGe("[oatpp::zlib::StreamingArchive::stepZip()]", "Error. Entry '{}' size doesn't match the data.",
+                       m_entries[m_entryIndex].name)
+            return IOError::BROKEN_PIPE;
+          }
+
+          writeZipDescriptor();
+
+          m_encoder.reset();
+          m_entryStream.reset();
+          m_entryIndex ++;
+          m_state = STATE_ENTRY_START;
+
+          return 0;
+
+        default:
+          return IOError::BROKEN_PIPE;
+
+      }
+
+    }
+
+    default:
+      return 0;
+
+  }
+
+}
+
+v_io_size StreamingArchive::produceTarInput() {
+
+  switch(m_state) {
+
+    case STATE_ENTRY_START:
+
+      if(m_entryIndex >= m_entries.size()) {
+        /* end of archive - two zero blocks */
+        m_tarPending.assign(2 * TAR_BLOCK_SIZE, '\0');
+        m_inData.set(m_tarPending.data(), m_tarPending.size());
+        m_state = STATE_END;
+        return 0;
+      }
+
+      if(!openEntry()) {
+        return IOError::BROKEN_PIPE;
+      }
+
+      writeTarHeader();
+      m_state = STATE_ENTRY_DATA;
+      return 0;
+
+    case STATE_ENTRY_DATA: {
+
+      if(m_entryLeft > 0) {
+
+        auto res = readEntry(std::min<v_int64>(m_bufferSize, m_entryLeft));
+
+        if(res > 0) {
+          m_entryLeft -= res;
+          m_inData.set(m_readBuffer.get(), res);
+          return 0;
+        } else if(res == 0) {
+          OATPP_LOGe("[oatpp::zlib::StreamingArchive::produceTarInput()]", "Error. Entry '{}' is shorter than its size.",
+                     m_entries[m_entryIndex].name)
+          return IOError::BROKEN_PIPE;
+        }
+
+        return res;
+
+      }
+
+      v_int64 padding = (TAR_BLOCK_SIZE - m_entrySize % TAR_BLOCK_SIZE) % TAR_BLOCK_SIZE;
+
+      m_entryStream.reset();
+      m_entryIndex ++;
+      m_state = STATE_ENTRY_START;
+
+      if(padding > 0) {
+        m_tarPending.assign((size_t) padding, '\0');
+        m_inData.set(m_tarPending.data(), m_tarPending.size());
+        return 0;
+      }
+
+      return produceTarInput();
+
+    }
+
+    case STATE_END:
+      m_inData.set(nullptr, 0);
+      m_state = STATE_FINISHING;
+      return 0;
+
+    default:
+      return 0;
+
+  }
+
+}
+
+v_io_size StreamingArchive::stepTar() {
+
+  if(m_inData.bytesLeft == 0 && m_inData.currBufferPtr != nullptr) {
+    auto res = produceTarInput();
+    if(res < 0) {
+      return res;
+    }
+  }
+
+  auto res = m_encoder->iterate(m_inData, m_outData);
+
+  switch(res) {
+
+    case DeflateEncoder::Error::PROVIDE_DATA_IN:
+    case DeflateEncoder::Error::FLUSH_DATA_OUT:
+      return 0;
+
+    case DeflateEncoder::Error::FINISHED:
+      m_state = STATE_DONE;
+      return 0;
+
+    default:
+      return IOError::BROKEN_PIPE;
+
+  }
+
+}
+
+v_io_size StreamingArchive::read(void *buffer, v_buff_size count, async::Action& action) {
+
+  (void) action;
+
+  if(m_error < 0) {
+    return m_error;
+  }
+
+  auto out = (p_char8) buffer;
+  v_buff_size written = 0;
+
+  while(written < count) {
+
+    if(m_outData.bytesLeft > 0) {
+      v_buff_size size = std::min(m_outData.bytesLeft, count - written);
+      std::memcpy(out + written, m_outData.currBufferPtr, size);
+      m_outData.inc(size);
+      written += size;
+      m_offset += size;
+      continue;
+    }
+
+    if(m_state == STATE_DONE) {
+      break;
+    }
+
+    v_io_size res = m_format == ArchiveFormat::ZIP ? stepZip() : stepTar();
+
+    if(res < 0) {
+      if(res != IOError::RETRY_READ && res != IOError::RETRY_WRITE) {
+        m_error = res;
+      }
+      if(written > 0) {
+        break;
+      }
+      return res;
+    }
+
+  }
+
+  return written;
+
+}
+
+}}
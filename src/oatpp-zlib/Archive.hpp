@@ -0,0 +1,203 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#ifndef oatpp_zlib_Archive_hpp
+#define oatpp_zlib_Archive_hpp
+
+#include "Processor.hpp"
+
+#include "oatpp/data/stream/Stream.hpp"
+#include "oatpp/Types.hpp"
+
+#include <string>
+#include <vector>
+
+namespace oatpp { namespace zlib {
+
+/**
+ * Archive format.
+ */
+enum class ArchiveFormat : v_int32 {
+
+  /**
+   * ZIP. Deflated entries, data descriptors, ZIP64 where needed.
+   */
+  ZIP = 0,
+
+  /**
+   * Gzip-compressed tar (ustar, PAX headers for long names and large sizes).
+   */
+  TAR_GZ = 1
+
+};
+
+/**
+ * Archive entry.
+ */
+struct ArchiveEntry {
+
+  /**
+   * Entry path in the archive. Use '/' as separator.
+   */
+  oatpp::String name;
+
+  /**
+   * Entry data. If `nullptr`, the file `filename` is opened when the entry is written.
+   */
+  std::shared_ptr<data::stream::ReadCallback> stream;
+
+  /**
+   * File to read entry data from.
+   */
+  oatpp::String filename;
+
+  /**
+   * Entry size. `-1` - unknown (not allowed for &l:ArchiveFormat::TAR_GZ; stream entries).
+   */
+  v_int64 size = -1;
+
+  /**
+   * Modification time. Seconds since epoch (UTC).
+   */
+  v_int64 modificationTime = 0;
+
+  /**
+   * Create entry from stream.
+   * @param name - entry path in the archive.
+   * @param stream - &id:oatpp::data::stream::ReadCallback;.
+   * @param size - exact size of the data or `-1` if unknown.
+   * @param modificationTime - seconds since epoch (UTC).
+   * @return - &l:ArchiveEntry;.
+   */
+  static ArchiveEntry createFromStream(const oatpp::String& name,
+                                       const std::shared_ptr<data::stream::ReadCallback>& stream,
+                                       v_int64 size = -1,
+                                       v_int64 modificationTime = 0);
+
+  /**
+   * Create entry from file. File is opened and its size is taken when the entry is written.
+   * @param name - entry path in the archive.
+   * @param filename - path to the file.
+   * @param modificationTime - seconds since epoch (UTC).
+   * @return - &l:ArchiveEntry;.
+   */
+  static ArchiveEntry createFromFile(const oatpp::String& name,
+                                     const oatpp::String& filename,
+                                     v_int64 modificationTime = 0);
+
+};
+
+/**
+ * Streaming archive. &id:oatpp::data::stream::ReadCallback; producing ZIP or tar.gz from a sequence of entries on the fly. <br>
+ * Entries are compressed with &l:DeflateEncoder; while they are read, CRC32 is computed on the way.
+ * Memory use doesn't depend on entry sizes - only the ZIP central directory grows with the number of entries.
+ * Use it as a body of the download response (ex.: `oatpp::web::protocol::http::outgoing::StreamingBody`). <br>
+ * Reads are blocking.
+ */
+class StreamingArchive : public data::stream::ReadCallback {
+private:
+
+  enum State : v_int32 {
+    STATE_ENTRY_START = 0,
+    STATE_ENTRY_DATA = 1,
+    STATE_ENTRY_PADDING = 2,
+    STATE_END = 3,
+    STATE_FINISHING = 4,
+    STATE_DONE = 5
+  };
+
+  struct ZipRecord {
+    std::string name;
+    v_uint32 crc;
+    v_uint64 compressedSize;
+    v_uint64 size;
+    v_uint64 offset;
+    v_uint16 dosTime;
+    v_uint16 dosDate;
+    bool zip64;
+  };
+
+private:
+  bool openEntry();
+  v_io_size readEntry(v_buff_size count);
+  v_io_size stepZip();
+  v_io_size stepTar();
+  v_io_size produceTarInput();
+  void writeZipLocalHeader();
+  void writeZipDescriptor();
+  void writeZipCentralDirectory();
+  void writeTarHeader();
+private:
+  ArchiveFormat m_format;
+  std::vector<ArchiveEntry> m_entries;
+  v_int32 m_compressionLevel;
+  v_buff_size m_bufferSize;
+  std::unique_ptr<v_char8[]> m_readBuffer;
+private:
+  v_int32 m_state;
+  size_t m_entryIndex;
+  std::shared_ptr<data::stream::ReadCallback> m_entryStream;
+  v_int64 m_entrySize;
+  v_int64 m_entryLeft;
+  v_uint64 m_entryRead;
+  v_uint32 m_entryCrc;
+  v_uint64 m_entryDataOffset;
+  bool m_entryZip64;
+  std::vector<ZipRecord> m_records;
+private:
+  std::shared_ptr<DeflateEncoder> m_encoder;
+  data::buffer::InlineReadData m_inData;
+  data::buffer::InlineReadData m_outData;
+  std::string m_pending;
+  std::string m_tarPending;
+  v_uint64 m_offset;
+  v_io_size m_error;
+public:
+
+  /**
+   * Constructor.
+   * @param format - &l:ArchiveFormat;.
+   * @param entries - &l:ArchiveEntry;.
+   * @param compressionLevel - deflate compression level.
+   * @param bufferSize - size of the read and compression buffers.
+   */
+  StreamingArchive(ArchiveFormat format,
+                   std::vector<ArchiveEntry> entries,
+                   v_int32 compressionLevel = Z_DEFAULT_COMPRESSION,
+                   v_buff_size bufferSize = 16 * 1024);
+
+  /**
+   * Read archive data.
+   * @param buffer - buffer to read data to.
+   * @param count - buffer size.
+   * @param action - async specific action. Not used - reads are blocking.
+   * @return - actual number of bytes read. `0` - end of archive. Negative value in case of error.
+   */
+  v_io_size read(void *buffer, v_buff_size count, async::Action& action) override;
+
+};
+
+}}
+
+#endif // oatpp_zlib_Archive_hpp
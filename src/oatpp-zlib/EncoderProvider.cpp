@@ -26,8 +26,31 @@
 
 #include "./Processor.hpp"
 
+#include <cctype>
+#include <cstdlib>
+
 namespace oatpp { namespace zlib {
 
+namespace {
+
+  /* output buffers start small for short responses and grow for large ones */
+  constexpr v_buff_size MIN_BUFFER_SIZE = 512;
+  constexpr v_buff_size MAX_BUFFER_SIZE = 64 * 1024;
+
+  std::shared_ptr<data::buffer::Processor> createEncoder(Format format) {
+    auto encoder = std::make_shared<DeflateEncoder>(MIN_BUFFER_SIZE, format);
+    encoder->setAdaptiveBufferSize(MIN_BUFFER_SIZE, MAX_BUFFER_SIZE);
+    return encoder;
+  }
+
+  std::shared_ptr<data::buffer::Processor> createDecoder(Format format) {
+    auto decoder = std::make_shared<DeflateDecoder>(MIN_BUFFER_SIZE, format);
+    decoder->setAdaptiveBufferSize(MIN_BUFFER_SIZE, MAX_BUFFER_SIZE);
+    return decoder;
+  }
+
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // DeflateEncoderProvider
 
@@ -36,7 +59,7 @@ oatpp::String DeflateEncoderProvider::getEncodingName() {
 }
 
 std::shared_ptr<data::buffer::Processor> DeflateEncoderProvider::getProcessor() {
-  return std::make_shared<DeflateEncoder>(2048, false);
+  return createEncoder(Format::ZLIB);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -47,7 +70,7 @@ oatpp::String DeflateDecoderProvider::getEncodingName() {
 }
 
 std::shared_ptr<data::buffer::Processor> DeflateDecoderProvider::getProcessor() {
-  return std::make_shared<DeflateDecoder>(2048, false);
+  return createDecoder(Format::ZLIB);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -58,7 +81,7 @@ oatpp::String GzipEncoderProvider::getEncodingName() {
 }
 
 std::shared_ptr<data::buffer::Processor> GzipEncoderProvider::getProcessor() {
-  return std::make_shared<DeflateEncoder>(2048, true);
+  return createEncoder(Format::GZIP);
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -69,7 +92,112 @@ oatpp::String GzipDecoderProvider::getEncodingName() {
 }
 
 std::shared_ptr<data::buffer::Processor> GzipDecoderProvider::getProcessor() {
-  return std::make_shared<DeflateDecoder>(2048, true);
+  return createDecoder(Format::GZIP);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// RawDeflateEncoderProvider
+
+oatpp::String RawDeflateEncoderProvider::getEncodingName() {
+  return "deflate-raw";
+}
+
+std::shared_ptr<data::buffer::Processor> RawDeflateEncoderProvider::getProcessor() {
+  return createEncoder(Format::RAW);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// RawDeflateDecoderProvider
+
+oatpp::String RawDeflateDecoderProvider::getEncodingName() {
+  return "deflate-raw";
+}
+
+std::shared_ptr<data::buffer::Processor> RawDeflateDecoderProvider::getProcessor() {
+  return createDecoder(Format::RAW);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// PassThroughEncoderProvider
+
+PassThroughEncoderProvider::PassThroughEncoderProvider(const oatpp::String& encodingName)
+  : m_encodingName(encodingName)
+{}
+
+bool PassThroughEncoderProvider::isAccepted(const oatpp::String& encoding, const oatpp::String& acceptEncoding) {
+
+  if(!encoding || !acceptEncoding) {
+    return false;
+  }
+
+  auto trim = [](const std::string& str, v_buff_size begin, v_buff_size end) {
+    while(begin < end && (str[begin] == ' ' || str[begin] == '\t')) begin ++;
+    while(end > begin && (str[end - 1] == ' ' || str[end - 1] == '\t')) end --;
+    return str.substr(begin, end - begin);
+  };
+
+  auto equalsIgnoreCase = [](const std::string& a, const std::string& b) {
+    if(a.size() != b.size()) return false;
+    for(size_t i = 0; i < a.size(); i ++) {
+      if(std::tolower((unsigned char) a[i]) != std::tolower((unsigned char) b[i])) return false;
+    }
+    return true;
+  };
+
+  const std::string& header = *acceptEncoding;
+  bool wildcard = false;
+  v_buff_size pos = 0;
+  v_buff_size size = (v_buff_size) header.size();
+
+  while(pos <= size) {
+
+    v_buff_size end = (v_buff_size) header.find(',', pos);
+    if(end < 0) end = size;
+
+    v_buff_size paramsPos = (v_buff_size) header.find(';', pos);
+    if(paramsPos < 0 || paramsPos > end) paramsPos = end;
+
+    auto token = trim(header, pos, paramsPos);
+
+    /* parameters - ";name=value" each. Only "q" matters */
+    bool acceptable = true;
+    v_buff_size paramPos = paramsPos;
+    while(paramPos < end) {
+
+      v_buff_size paramEnd = (v_buff_size) header.find(';', paramPos + 1);
+      if(paramEnd < 0 || paramEnd > end) paramEnd = end;
+
+      v_buff_size eqPos = (v_buff_size) header.find('=', paramPos + 1);
+      if(eqPos >= 0 && eqPos < paramEnd && equalsIgnoreCase(trim(header, paramPos + 1, eqPos), "q")) {
+        acceptable = std::strtod(trim(header, eqPos + 1, paramEnd).c_str(), nullptr) > 0;
+      }
+
+      paramPos = paramEnd;
+
+    }
+
+    if(equalsIgnoreCase(token, *encoding)) {
+      return acceptable;
+    }
+
+    if(token == "*") {
+      wildcard = acceptable;
+    }
+
+    pos = end + 1;
+
+  }
+
+  return wildcard;
+
+}
+
+oatpp::String PassThroughEncoderProvider::getEncodingName() {
+  return m_encodingName;
+}
+
+std::shared_ptr<data::buffer::Processor> PassThroughEncoderProvider::getProcessor() {
+  return std::make_shared<PassThroughProcessor>(2048);
 }
 
 }}
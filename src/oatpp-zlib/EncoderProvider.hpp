@@ -109,6 +109,88 @@ public:
 
 };
 
+/**
+ * EncoderProvider for raw deflate encoding - no header, no checksum. <br>
+ * Not a standard HTTP content-coding. Use it for trusted service-to-service links (ex.: over TLS)
+ * where both sides use oatpp-zlib.
+ */
+class RawDeflateEncoderProvider : public web::protocol::http::encoding::EncoderProvider {
+public:
+
+  /**
+   * Get encoding name.
+   * @return - "deflate-raw".
+   */
+  oatpp::String getEncodingName() override;
+
+  /**
+   * Get &id:oatpp::data::buffer::Processor; for chunked encoding.
+   * @return - &id:oatpp::data::buffer::Processor;
+   */
+  std::shared_ptr<data::buffer::Processor> getProcessor() override;
+
+};
+
+/**
+ * EncoderProvider for raw deflate decoding - no header, no checksum.
+ */
+class RawDeflateDecoderProvider : public web::protocol::http::encoding::EncoderProvider {
+public:
+
+  /**
+   * Get encoding name.
+   * @return - "deflate-raw".
+   */
+  oatpp::String getEncodingName() override;
+
+  /**
+   * Get &id:oatpp::data::buffer::Processor; for chunked decoding.
+   * @return - &id:oatpp::data::buffer::Processor;
+   */
+  std::shared_ptr<data::buffer::Processor> getProcessor() override;
+
+};
+
+/**
+ * EncoderProvider for content which is already encoded. <br>
+ * Its processor forwards encoded bytes untouched, so relaying an upstream response
+ * with matching `Content-Encoding` costs no compression work. <br>
+ * Use it only for content known to be encoded - don't add it to the server-wide encoder collection,
+ * otherwise every response is labeled with its encoding.
+ */
+class PassThroughEncoderProvider : public web::protocol::http::encoding::EncoderProvider {
+private:
+  oatpp::String m_encodingName;
+public:
+
+  /**
+   * Constructor.
+   * @param encodingName - encoding of the relayed content. Ex.: "gzip", "deflate".
+   */
+  PassThroughEncoderProvider(const oatpp::String& encodingName);
+
+  /**
+   * Check if content encoded with `encoding` can be sent as-is to a client with the given `Accept-Encoding` header.
+   * @param encoding - content encoding. Ex.: upstream `Content-Encoding` header value.
+   * @param acceptEncoding - client `Accept-Encoding` header value.
+   * @return - `true` if the client accepts `encoding`.
+   */
+  static bool isAccepted(const oatpp::String& encoding, const oatpp::String& acceptEncoding);
+
+  /**
+   * Get encoding name.
+   * @return
+   */
+  oatpp::String getEncodingName() override;
+
+  /**
+   * Get &id:oatpp::data::buffer::Processor; forwarding content untouched.
+   * @return - &id:oatpp::data::buffer::Processor;
+   */
+  std::shared_ptr<data::buffer::Processor> getProcessor() override;
+
+};
+
 }}
 
 #endif //oatpp_zlib_EncoderProvider_hpp
@@ -0,0 +1,130 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#include "GzipStitcher.hpp"
+
+namespace oatpp { namespace zlib {
+
+namespace {
+
+  /* ID1, ID2, CM = deflate, FLG, MTIME, XFL, OS = unknown */
+  const v_char8 GZIP_HEADER[10] = {0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff};
+
+  /* empty fixed-Huffman block with BFINAL set - written at the byte boundary left by a sync flush */
+  const v_char8 FINAL_BLOCK[2] = {0x03, 0x00};
+
+  void writeUInt32LE(data::stream::BufferOutputStream& stream, v_uint32 value) {
+    v_char8 bytes[4] = {(v_char8) value, (v_char8) (value >> 8), (v_char8) (value >> 16), (v_char8) (value >> 24)};
+    stream.writeSimple(bytes, 4);
+  }
+
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// GzipFragment
+
+std::shared_ptr<GzipFragment> GzipFragment::compress(const oatpp::String& content, v_int32 compressionLevel) {
+
+  std::string empty;
+  const std::string& text = content ? *content : empty;
+
+  DeflateEncoder encoder(4096, Format::RAW, compressionLevel);
+  data::stream::BufferOutputStream stream;
+
+  data::buffer::InlineReadData dataIn((void*) text.data(), (v_buff_size) text.size());
+  data::buffer::InlineReadData dataOut;
+
+  encoder.flush();
+
+  v_int32 res;
+  while((res = encoder.iterate(dataIn, dataOut)) == data::buffer::Processor::Error::FLUSH_DATA_OUT) {
+    stream.writeSimple(dataOut.currBufferPtr, dataOut.bytesLeft);
+    dataOut.setEof();
+  }
+
+  if(res != data::buffer::Processor::Error::PROVIDE_DATA_IN || dataIn.bytesLeft > 0) {
+    throw std::runtime_error("[oatpp::zlib::GzipFragment::compress()]: Error. Can't compress fragment.");
+  }
+
+  /* everything up to the sync flush point is the fragment */
+  auto fragmentSize = stream.getCurrentPosition();
+
+  /* finish the stream so that the encoder is released cleanly - the final block is dropped */
+  data::buffer::InlineReadData end(nullptr, 0);
+  while((res = encoder.iterate(end, dataOut)) == data::buffer::Processor::Error::FLUSH_DATA_OUT) {
+    stream.writeSimple(dataOut.currBufferPtr, dataOut.bytesLeft);
+    dataOut.setEof();
+  }
+
+  if(res != data::buffer::Processor::Error::FINISHED) {
+    throw std::runtime_error("[oatpp::zlib::GzipFragment::compress()]: Error. Can't finish fragment.");
+  }
+
+  auto fragment = std::make_shared<GzipFragment>();
+  fragment->data = stream.getSubstring(0, fragmentSize);
+  fragment->crc = (v_uint32) crc32(0L, (const Bytef *) text.data(), (uInt) text.size());
+  fragment->size = (v_int64) text.size();
+  return fragment;
+
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// GzipStitcher
+
+GzipStitcher::GzipStitcher(v_int32 compressionLevel)
+  : m_compressionLevel(compressionLevel)
+  , m_crc(0)
+  , m_size(0)
+{
+  m_stream.writeSimple(GZIP_HEADER, sizeof(GZIP_HEADER));
+}
+
+void GzipStitcher::append(const std::shared_ptr<GzipFragment>& fragment) {
+  m_stream.writeSimple(fragment->data->data(), (v_buff_size) fragment->data->size());
+  m_crc = (v_uint32) crc32_combine(m_crc, fragment->crc, (z_off_t) fragment->size);
+  m_size += fragment->size;
+}
+
+void GzipStitcher::appendDynamic(const oatpp::String& content) {
+  append(GzipFragment::compress(content, m_compressionLevel));
+}
+
+oatpp::String GzipStitcher::finish() {
+
+  m_stream.writeSimple(FINAL_BLOCK, sizeof(FINAL_BLOCK));
+  writeUInt32LE(m_stream, m_crc);
+  writeUInt32LE(m_stream, (v_uint32) m_size);
+
+  auto result = m_stream.toString();
+
+  m_stream.setCurrentPosition(0);
+  m_stream.writeSimple(GZIP_HEADER, sizeof(GZIP_HEADER));
+  m_crc = 0;
+  m_size = 0;
+
+  return result;
+
+}
+
+}}
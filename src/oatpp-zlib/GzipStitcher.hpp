@@ -0,0 +1,107 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#ifndef oatpp_zlib_GzipStitcher_hpp
+#define oatpp_zlib_GzipStitcher_hpp
+
+#include "Processor.hpp"
+
+#include "oatpp/data/stream/BufferStream.hpp"
+
+namespace oatpp { namespace zlib {
+
+/**
+ * Content fragment compressed to raw deflate ending at a sync-flush boundary. <br>
+ * Such fragments can be joined one after another - see &l:GzipStitcher;.
+ */
+struct GzipFragment {
+
+  /**
+   * Raw deflate data. Has no final block.
+   */
+  oatpp::String data;
+
+  /**
+   * CRC-32 of the uncompressed content.
+   */
+  v_uint32 crc;
+
+  /**
+   * Size of the uncompressed content.
+   */
+  v_int64 size;
+
+  /**
+   * Compress content with &l:DeflateEncoder; (&l:Format::RAW;) and a sync flush at the end.
+   * @param content
+   * @param compressionLevel
+   * @return
+   */
+  static std::shared_ptr<GzipFragment> compress(const oatpp::String& content, v_int32 compressionLevel = Z_DEFAULT_COMPRESSION);
+
+};
+
+/**
+ * Assembles one gzip stream from compressed fragments. <br>
+ * Compress static fragments once with &l:GzipFragment::compress (); and reuse them for every response -
+ * only dynamic fragments are compressed per response. The resulting stream has one gzip member,
+ * its CRC-32 is combined from fragment CRCs with `crc32_combine()`.
+ */
+class GzipStitcher {
+private:
+  data::stream::BufferOutputStream m_stream;
+  v_int32 m_compressionLevel;
+  v_uint32 m_crc;
+  v_int64 m_size;
+public:
+
+  /**
+   * Constructor.
+   * @param compressionLevel - compression level for dynamic fragments.
+   */
+  GzipStitcher(v_int32 compressionLevel = Z_DEFAULT_COMPRESSION);
+
+  /**
+   * Append precompressed fragment.
+   * @param fragment - &l:GzipFragment;.
+   */
+  void append(const std::shared_ptr<GzipFragment>& fragment);
+
+  /**
+   * Compress and append dynamic fragment.
+   * @param content
+   */
+  void appendDynamic(const oatpp::String& content);
+
+  /**
+   * Finish the stream - write final block and gzip trailer. The stitcher is reset and can be reused.
+   * @return - gzip stream.
+   */
+  oatpp::String finish();
+
+};
+
+}}
+
+#endif // oatpp_zlib_GzipStitcher_hpp
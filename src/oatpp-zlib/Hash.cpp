@@ -0,0 +1,170 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#include "Hash.hpp"
+
+#include <cstring>
+
+namespace oatpp { namespace zlib {
+
+namespace {
+
+  constexpr v_uint64 PRIME_1 = 11400714785074694791ULL;
+  constexpr v_uint64 PRIME_2 = 14029467366897019727ULL;
+  constexpr v_uint64 PRIME_3 = 1609587929392839161ULL;
+  constexpr v_uint64 PRIME_4 = 9650029242287828579ULL;
+  constexpr v_uint64 PRIME_5 = 2870177450012600261ULL;
+
+  inline v_uint64 rotl(v_uint64 value, v_int32 bits) {
+    return (value << bits) | (value >> (64 - bits));
+  }
+
+  inline v_uint64 read64(const v_char8* p) {
+    /* little-endian regardless of the host byte order */
+    return  (v_uint64) p[0]        | ((v_uint64) p[1] << 8)  | ((v_uint64) p[2] << 16) | ((v_uint64) p[3] << 24) |
+           ((v_uint64) p[4] << 32) | ((v_uint64) p[5] << 40) | ((v_uint64) p[6] << 48) | ((v_uint64) p[7] << 56);
+  }
+
+  inline v_uint64 read32(const v_char8* p) {
+    return (v_uint64) p[0] | ((v_uint64) p[1] << 8) | ((v_uint64) p[2] << 16) | ((v_uint64) p[3] << 24);
+  }
+
+  inline v_uint64 round(v_uint64 acc, v_uint64 input) {
+    acc += input * PRIME_2;
+    acc = rotl(acc, 31);
+    return acc * PRIME_1;
+  }
+
+  inline v_uint64 mergeRound(v_uint64 acc, v_uint64 value) {
+    acc ^= round(0, value);
+    return acc * PRIME_1 + PRIME_4;
+  }
+
+}
+
+XXHash64::XXHash64(v_uint64 seed) {
+  reset(seed);
+}
+
+void XXHash64::reset(v_uint64 seed) {
+  m_seed = seed;
+  m_acc[0] = seed + PRIME_1 + PRIME_2;
+  m_acc[1] = seed + PRIME_2;
+  m_acc[2] = seed;
+  m_acc[3] = seed - PRIME_1;
+  m_totalSize = 0;
+  m_tailSize = 0;
+}
+
+void XXHash64::update(const void* data, v_buff_size size) {
+
+  auto p = (const v_char8*) data;
+  auto end = p + size;
+
+  m_totalSize += size;
+
+  if(m_tailSize + size < 32) {
+    std::memcpy(m_tail + m_tailSize, p, size);
+    m_tailSize += size;
+    return;
+  }
+
+  if(m_tailSize > 0) {
+    v_buff_size fill = 32 - m_tailSize;
+    std::memcpy(m_tail + m_tailSize, p, fill);
+    p += fill;
+    m_acc[0] = round(m_acc[0], read64(m_tail));
+    m_acc[1] = round(m_acc[1], read64(m_tail + 8));
+    m_acc[2] = round(m_acc[2], read64(m_tail + 16));
+    m_acc[3] = round(m_acc[3], read64(m_tail + 24));
+    m_tailSize = 0;
+  }
+
+  while(end - p >= 32) {
+    m_acc[0] = round(m_acc[0], read64(p));
+    m_acc[1] = round(m_acc[1], read64(p + 8));
+    m_acc[2] = round(m_acc[2], read64(p + 16));
+    m_acc[3] = round(m_acc[3], read64(p + 24));
+    p += 32;
+  }
+
+  m_tailSize = end - p;
+  std::memcpy(m_tail, p, m_tailSize);
+
+}
+
+v_uint64 XXHash64::digest() const {
+
+  v_uint64 h;
+
+  if(m_totalSize >= 32) {
+    h = rotl(m_acc[0], 1) + rotl(m_acc[1], 7) + rotl(m_acc[2], 12) + rotl(m_acc[3], 18);
+    h = mergeRound(h, m_acc[0]);
+    h = mergeRound(h, m_acc[1]);
+    h = mergeRound(h, m_acc[2]);
+    h = mergeRound(h, m_acc[3]);
+  } else {
+    h = m_seed + PRIME_5;
+  }
+
+  h += m_totalSize;
+
+  const v_char8* p = m_tail;
+  const v_char8* end = m_tail + m_tailSize;
+
+  while(end - p >= 8) {
+    h ^= round(0, read64(p));
+    h = rotl(h, 27) * PRIME_1 + PRIME_4;
+    p += 8;
+  }
+
+  if(end - p >= 4) {
+    h ^= read32(p) * PRIME_1;
+    h = rotl(h, 23) * PRIME_2 + PRIME_3;
+    p += 4;
+  }
+
+  while(p < end) {
+    h ^= (*p) * PRIME_5;
+    h = rotl(h, 11) * PRIME_1;
+    p ++;
+  }
+
+  h ^= h >> 33;
+  h *= PRIME_2;
+  h ^= h >> 29;
+  h *= PRIME_3;
+  h ^= h >> 32;
+
+  return h;
+
+}
+
+v_uint64 XXHash64::hash(const void* data, v_buff_size size, v_uint64 seed) {
+  XXHash64 hash(seed);
+  hash.update(data, size);
+  return hash.digest();
+}
+
+}}
@@ -0,0 +1,109 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#ifndef oatpp_zlib_Hash_hpp
+#define oatpp_zlib_Hash_hpp
+
+#include "oatpp/Environment.hpp"
+
+namespace oatpp { namespace zlib {
+
+/**
+ * Content hash algorithm.
+ */
+enum class HashAlgorithm : v_int32 {
+
+  /**
+   * No hash.
+   */
+  NONE = 0,
+
+  /**
+   * CRC-32 as used by gzip. 32-bit checksum - detects corruption, too weak for cache keys or ETags.
+   */
+  CRC32 = 1,
+
+  /**
+   * Adler-32 as used by zlib. 32-bit checksum - detects corruption, too weak for cache keys or ETags.
+   */
+  ADLER32 = 2,
+
+  /**
+   * xxHash64. See &l:XXHash64;.
+   */
+  XXHASH64 = 3
+
+};
+
+/**
+ * Streaming xxHash64 (XXH64). Fast non-cryptographic hash.
+ */
+class XXHash64 {
+private:
+  v_uint64 m_acc[4];
+  v_uint64 m_seed;
+  v_uint64 m_totalSize;
+  v_char8 m_tail[32];
+  v_buff_size m_tailSize;
+public:
+
+  /**
+   * Constructor.
+   * @param seed
+   */
+  XXHash64(v_uint64 seed = 0);
+
+  /**
+   * Reset hash state.
+   * @param seed
+   */
+  void reset(v_uint64 seed = 0);
+
+  /**
+   * Add data to the hash.
+   * @param data
+   * @param size
+   */
+  void update(const void* data, v_buff_size size);
+
+  /**
+   * Get hash of the data added so far. Doesn't change the state - more data may be added.
+   * @return
+   */
+  v_uint64 digest() const;
+
+  /**
+   * Compute hash of the data.
+   * @param data
+   * @param size
+   * @param seed
+   * @return
+   */
+  static v_uint64 hash(const void* data, v_buff_size size, v_uint64 seed = 0);
+
+};
+
+}}
+
+#endif // oatpp_zlib_Hash_hpp
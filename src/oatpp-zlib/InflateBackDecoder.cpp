@@ -0,0 +1,351 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#include "InflateBackDecoder.hpp"
+
+#include "oatpp/base/Log.hpp"
+
+namespace oatpp { namespace zlib {
+
+InflateBackDecoder::InflateBackDecoder(Format format, v_buff_size inputBufferSize)
+  : m_format(format)
+  , m_window(new v_char8[1 << 15])
+  , m_input(new v_char8[inputBufferSize])
+  , m_inputSize(inputBufferSize)
+  , m_inPos(0)
+  , m_inSize(0)
+  , m_readCallback(nullptr)
+  , m_writeCallback(nullptr)
+  , m_checksum(0)
+  , m_memberSize(0)
+  , m_outSize(0)
+  , m_ioError(0)
+{
+
+  m_zStream.zalloc = Z_NULL;
+  m_zStream.zfree = Z_NULL;
+  m_zStream.opaque = Z_NULL;
+
+  m_zStream.next_in = nullptr;
+  m_zStream.avail_in = 0;
+
+  v_int32 res = inflateBackInit(&m_zStream, 15, m_window.get());
+
+  if(res != Z_OK) {
+    OATPP_LOGe("[oatpp::zlib::InflateBackDecoder::InflateBackDecoder()]", "Error. Failed call to 'inflateBackInit()'. Result {}", res)
+    throw std::runtime_error("[oatpp::zlib::InflateBackDecoder::InflateBackDecoder()]: Error. Can't init.");
+  }
+
+}
+
+InflateBackDecoder::~InflateBackDecoder() {
+  v_int32 res = inflateBackEnd(&m_zStream);
+  if(res != Z_OK) {
+    OATPP_LOGe("[oatpp::zlib::InflateBackDecoder::~InflateBackDecoder()]", "Error. Failed call to 'inflateBackEnd()'. Result {}", res)
+  }
+}
+
+bool InflateBackDecoder::fillInput() {
+
+  while(true) {
+
+    auto res = m_readCallback->readSimple(m_input.get(), m_inputSize);
+
+    if(res > 0) {
+      m_inPos = 0;
+      m_inSize = res;
+      return true;
+    }
+
+    if(res == IOError::RETRY_READ || res == IOError::RETRY_WRITE) {
+      continue;
+    }
+
+    if(res < 0) {
+      m_ioError = res;
+    }
+
+    return false;
+
+  }
+
+}
+
+bool InflateBackDecoder::hasInput() {
+  return m_inPos < m_inSize || fillInput();
+}
+
+bool InflateBackDecoder::readByte(v_uint8& byte) {
+  if(m_inPos >= m_inSize && !fillInput()) {
+    return false;
+  }
+  byte = m_input[m_inPos ++];
+  return true;
+}
+
+bool InflateBackDecoder::readBytes(v_uint8* bytes, v_buff_size count) {
+  for(v_buff_size i = 0; i < count; i ++) {
+    if(!readByte(bytes[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool InflateBackDecoder::skipBytes(v_buff_size count) {
+  v_uint8 byte;
+  for(v_buff_size i = 0; i < count; i ++) {
+    if(!readByte(byte)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool InflateBackDecoder::skipString() {
+  v_uint8 byte;
+  do {
+    if(!readByte(byte)) {
+      return false;
+    }
+  } while(byte != 0);
+  return true;
+}
+
+v_io_size InflateBackDecoder::getInputError() {
+  /* end of input in the middle of the header/trailer - truncated stream */
+  return m_ioError < 0 ? m_ioError : ERROR_FORMAT;
+}
+
+v_io_size InflateBackDecoder::readZlibHeader() {
+
+  v_uint8 header[2];
+  if(!readBytes(header, 2)) {
+    return getInputError();
+  }
+
+  if((header[0] & 0x0F) != Z_DEFLATED || (header[0] >> 4) > 7 || ((header[0] << 8) | header[1]) % 31 != 0) {
+    return ERROR_FORMAT;
+  }
+
+  /* preset dictionary is not supported */
+  if(header[1] & 0x20) {
+    return ERROR_FORMAT;
+  }
+
+  return 0;
+
+}
+
+v_io_size InflateBackDecoder::readGzipHeader() {
+
+  v_uint8 header[10];
+  if(!readBytes(header, 10)) {
+    return getInputError();
+  }
+
+  if(header[0] != 0x1f || header[1] != 0x8b || header[2] != Z_DEFLATED || (header[3] & 0xE0) != 0) {
+    return ERROR_FORMAT;
+  }
+
+  v_uint8 flags = header[3];
+
+  if(flags & 0x04) { // FEXTRA
+    v_uint8 size[2];
+    if(!readBytes(size, 2) || !skipBytes(size[0] | (size[1] << 8))) {
+      return getInputError();
+    }
+  }
+
+  if((flags & 0x08) && !skipString()) { // FNAME
+    return getInputError();
+  }
+
+  if((flags & 0x10) && !skipString()) { // FCOMMENT
+    return getInputError();
+  }
+
+  if((flags & 0x02) && !skipBytes(2)) { // FHCRC
+    return getInputError();
+  }
+
+  return 0;
+
+}
+
+v_io_size InflateBackDecoder::readTrailer() {
+
+  switch(m_format) {
+
+    case Format::ZLIB: {
+      v_uint8 trailer[4];
+      if(!readBytes(trailer, 4)) {
+        return getInputError();
+      }
+      v_uint32 adler = ((v_uint32) trailer[0] << 24) | ((v_uint32) trailer[1] << 16) | ((v_uint32) trailer[2] << 8) | trailer[3];
+      if(adler != m_checksum) {
+        return ERROR_CHECKSUM;
+      }
+      return 0;
+    }
+
+    case Format::GZIP: {
+      v_uint8 trailer[8];
+      if(!readBytes(trailer, 8)) {
+        return getInputError();
+      }
+      v_uint32 crc = trailer[0] | ((v_uint32) trailer[1] << 8) | ((v_uint32) trailer[2] << 16) | ((v_uint32) trailer[3] << 24);
+      v_uint32 size = trailer[4] | ((v_uint32) trailer[5] << 8) | ((v_uint32) trailer[6] << 16) | ((v_uint32) trailer[7] << 24);
+      if(crc != m_checksum || size != (v_uint32) m_memberSize) {
+        return ERROR_CHECKSUM;
+      }
+      return 0;
+    }
+
+    default:
+      return 0;
+
+  }
+
+}
+
+unsigned InflateBackDecoder::readInput(void* desc, z_const unsigned char** buffer) {
+
+  auto self = static_cast<InflateBackDecoder*>(desc);
+
+  if(self->m_inPos >= self->m_inSize && !self->fillInput()) {
+    return 0;
+  }
+
+  *buffer = self->m_input.get() + self->m_inPos;
+  unsigned size = (unsigned) (self->m_inSize - self->m_inPos);
+  self->m_inPos = self->m_inSize;
+
+  return size;
+
+}
+
+int InflateBackDecoder::writeOutput(void* desc, unsigned char* buffer, unsigned size) {
+
+  auto self = static_cast<InflateBackDecoder*>(desc);
+
+  self->m_memberSize += size;
+  self->m_outSize += size;
+
+  switch(self->m_format) {
+    case Format::GZIP: self->m_checksum = crc32(self->m_checksum, buffer, size); break;
+    case Format::ZLIB: self->m_checksum = adler32(self->m_checksum, buffer, size); break;
+    default: break;
+  }
+
+  auto res = self->m_writeCallback->writeExactSizeDataSimple(buffer, size);
+  if(res != (v_io_size) size) {
+    self->m_ioError = res < 0 ? res : (v_io_size) IOError::BROKEN_PIPE;
+    return 1;
+  }
+
+  return 0;
+
+}
+
+v_io_size InflateBackDecoder::decodeMember() {
+
+  m_memberSize = 0;
+  m_checksum = m_format == Format::ZLIB ? adler32(0, Z_NULL, 0) : crc32(0, Z_NULL, 0);
+
+  v_io_size res = 0;
+  switch(m_format) {
+    case Format::GZIP: res = readGzipHeader(); break;
+    case Format::ZLIB: res = readZlibHeader(); break;
+    default: break;
+  }
+
+  if(res == 0) {
+
+    m_zStream.next_in = Z_NULL;
+    m_zStream.avail_in = 0;
+
+    v_int32 zres = inflateBack(&m_zStream, readInput, this, writeOutput, this);
+
+    if(zres == Z_STREAM_END) {
+      /* input left after the deflate stream - starts with the trailer */
+      m_inPos = m_inSize - m_zStream.avail_in;
+      res = readTrailer();
+    } else if(m_ioError < 0) {
+      res = m_ioError;
+    } else {
+      res = ERROR_FORMAT;
+    }
+
+  }
+
+  return res;
+
+}
+
+v_io_size InflateBackDecoder::decode(const base::ObjectHandle<data::stream::ReadCallback>& readCallback,
+                                     const base::ObjectHandle<data::stream::WriteCallback>& writeCallback)
+{
+
+  m_readCallback = readCallback.get();
+  m_writeCallback = writeCallback.get();
+
+  m_inPos = 0;
+  m_inSize = 0;
+  m_outSize = 0;
+  m_ioError = 0;
+
+  v_io_size res = decodeMember();
+
+  while(res == 0) {
+
+    if(!hasInput()) {
+      if(m_ioError < 0) {
+        res = m_ioError;
+      }
+      break;
+    }
+
+    /* data after the end of stream - next gzip member (same as DeflateDecoder), otherwise invalid */
+    if(m_format != Format::GZIP) {
+      res = ERROR_FORMAT;
+      break;
+    }
+
+    res = decodeMember();
+
+  }
+
+  m_readCallback = nullptr;
+  m_writeCallback = nullptr;
+
+  if(res < 0) {
+    return res;
+  }
+
+  return (v_io_size) m_outSize;
+
+}
+
+}}
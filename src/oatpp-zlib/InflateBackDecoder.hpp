@@ -0,0 +1,111 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#ifndef oatpp_zlib_InflateBackDecoder_hpp
+#define oatpp_zlib_InflateBackDecoder_hpp
+
+#include "Processor.hpp"
+
+#include "oatpp/data/stream/Stream.hpp"
+
+namespace oatpp { namespace zlib {
+
+/**
+ * Blocking decoder built on zlib `inflateBack()`. <br>
+ * Decodes the whole stream from &id:oatpp::data::stream::ReadCallback; to &id:oatpp::data::stream::WriteCallback;.
+ * zlib decodes into its window and the window is written to the output directly - there is no intermediate output buffer.
+ * Gzip and zlib headers and trailers are parsed by the decoder, checksums are verified. <br>
+ * Gzip members following each other are decoded as one stream (same as &l:DeflateDecoder;).
+ * Data after the end of zlib or raw stream is an error.
+ */
+class InflateBackDecoder {
+public:
+
+  /**
+   * Invalid header or compressed data.
+   */
+  static constexpr v_io_size ERROR_FORMAT = -100;
+
+  /**
+   * Checksum or size in the trailer doesn't match the decoded data.
+   */
+  static constexpr v_io_size ERROR_CHECKSUM = -101;
+
+private:
+  static unsigned readInput(void* desc, z_const unsigned char** buffer);
+  static int writeOutput(void* desc, unsigned char* buffer, unsigned size);
+private:
+  bool fillInput();
+  bool hasInput();
+  bool readByte(v_uint8& byte);
+  bool readBytes(v_uint8* bytes, v_buff_size count);
+  bool skipBytes(v_buff_size count);
+  bool skipString();
+  v_io_size getInputError();
+  v_io_size readGzipHeader();
+  v_io_size readZlibHeader();
+  v_io_size readTrailer();
+  v_io_size decodeMember();
+private:
+  Format m_format;
+  std::unique_ptr<v_char8[]> m_window;
+  std::unique_ptr<v_char8[]> m_input;
+  v_buff_size m_inputSize;
+  v_buff_size m_inPos;
+  v_buff_size m_inSize;
+  z_stream m_zStream;
+private:
+  data::stream::ReadCallback* m_readCallback;
+  data::stream::WriteCallback* m_writeCallback;
+  v_uint32 m_checksum;
+  v_uint64 m_memberSize;
+  v_uint64 m_outSize;
+  v_io_size m_ioError;
+public:
+
+  /**
+   * Constructor.
+   * @param format - &l:Format;.
+   * @param inputBufferSize - size of the buffer to read compressed data to.
+   */
+  InflateBackDecoder(Format format, v_buff_size inputBufferSize = 16 * 1024);
+
+  ~InflateBackDecoder();
+
+  /**
+   * Decode stream. The decoder may be reused for the next stream.
+   * @param readCallback - compressed data.
+   * @param writeCallback - decoded data is written here.
+   * @return - number of decoded bytes written or negative value in case of error -
+   * &l:InflateBackDecoder::ERROR_FORMAT; (also for data after the end of zlib or raw stream),
+   * &l:InflateBackDecoder::ERROR_CHECKSUM; or I/O error.
+   */
+  v_io_size decode(const base::ObjectHandle<data::stream::ReadCallback>& readCallback,
+                   const base::ObjectHandle<data::stream::WriteCallback>& writeCallback);
+
+};
+
+}}
+
+#endif // oatpp_zlib_InflateBackDecoder_hpp
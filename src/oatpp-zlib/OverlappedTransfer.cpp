@@ -0,0 +1,246 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#include "OverlappedTransfer.hpp"
+
+namespace oatpp { namespace zlib {
+
+namespace {
+
+class OverlappedTransferCoroutine : public async::Coroutine<OverlappedTransferCoroutine> {
+private:
+  base::ObjectHandle<data::stream::ReadCallback> m_readCallback;
+  base::ObjectHandle<data::stream::WriteCallback> m_writeCallback;
+  v_buff_size m_transferSize;
+  base::ObjectHandle<data::buffer::IOBuffer> m_buffer;
+  base::ObjectHandle<data::buffer::Processor> m_processor;
+private:
+  v_buff_size m_progress;
+  v_int32 m_processRes;
+  v_io_size m_aheadError;
+  bool m_inputEnded;
+  data::buffer::InlineReadData m_inData;
+  data::buffer::InlineReadData m_outData;
+private:
+
+  v_buff_size getReadSize() {
+    v_buff_size desiredToRead = m_processor->suggestInputStreamReadSize();
+    if(desiredToRead > m_buffer->getSize()) {
+      desiredToRead = m_buffer->getSize();
+    }
+    if(m_transferSize > 0 && desiredToRead > m_transferSize - m_progress) {
+      desiredToRead = m_transferSize - m_progress;
+    }
+    return desiredToRead;
+  }
+
+  void setInputEnded() {
+    m_inData.set(nullptr, 0);
+    m_inputEnded = true;
+  }
+
+  void readAhead() {
+
+    v_buff_size desiredToRead = getReadSize();
+    if(desiredToRead == 0) {
+      setInputEnded();
+      return;
+    }
+
+    /* an action means there is no input without waiting - it is dropped, the read is repeated after the write */
+    async::Action action;
+    v_io_size res = m_readCallback->read(m_buffer->getData(), desiredToRead, action);
+
+    if(!action.isNone()) {
+      return;
+    }
+
+    if(res > 0) {
+      m_inData.set(m_buffer->getData(), res);
+      m_progress += res;
+    } else if(res == 0 || res == IOError::ZERO_VALUE) {
+      setInputEnded();
+    } else if(res != IOError::RETRY_READ && res != IOError::RETRY_WRITE) {
+      m_aheadError = res;
+    }
+
+  }
+
+  void processAhead() {
+
+    if(m_aheadError != 0) {
+      return;
+    }
+
+    /* consumed input may be reused by the client */
+    if(m_inData.bytesLeft == 0 && !m_inputEnded) {
+      readAhead();
+      if(m_aheadError != 0) {
+        return;
+      }
+    }
+
+    /* dataOut is pending - the processor works ahead and leaves dataOut untouched */
+    v_int32 res = m_processor->iterate(m_inData, m_outData);
+    if(res != data::buffer::Processor::Error::FLUSH_DATA_OUT &&
+       res != data::buffer::Processor::Error::PROVIDE_DATA_IN &&
+       res != data::buffer::Processor::Error::FINISHED)
+    {
+      m_aheadError = IOError::BROKEN_PIPE;
+    }
+
+  }
+
+public:
+
+  OverlappedTransferCoroutine(const base::ObjectHandle<data::stream::ReadCallback>& readCallback,
+                              const base::ObjectHandle<data::stream::WriteCallback>& writeCallback,
+                              v_buff_size transferSize,
+                              const base::ObjectHandle<data::buffer::IOBuffer>& buffer,
+                              const base::ObjectHandle<data::buffer::Processor>& processor)
+    : m_readCallback(readCallback)
+    , m_writeCallback(writeCallback)
+    , m_transferSize(transferSize)
+    , m_buffer(buffer)
+    , m_processor(processor)
+    , m_progress(0)
+    , m_processRes(data::buffer::Processor::Error::PROVIDE_DATA_IN)
+    , m_aheadError(0)
+    , m_inputEnded(false)
+  {}
+
+  Action act() {
+
+    if(m_aheadError != 0) {
+      return error<AsyncIOError>("[oatpp::zlib::transferOverlappedAsync()]: Error. Failed to process data ahead.", m_aheadError);
+    }
+
+    if(m_processRes == data::buffer::Processor::Error::PROVIDE_DATA_IN && m_inData.bytesLeft == 0 && !m_inputEnded) {
+      return yieldTo(&OverlappedTransferCoroutine::readInput);
+    }
+
+    return yieldTo(&OverlappedTransferCoroutine::process);
+
+  }
+
+  Action readInput() {
+
+    v_buff_size desiredToRead = getReadSize();
+    if(desiredToRead == 0) {
+      setInputEnded();
+      return yieldTo(&OverlappedTransferCoroutine::process);
+    }
+
+    async::Action action;
+    v_io_size res = m_readCallback->read(m_buffer->getData(), desiredToRead, action);
+
+    if(!action.isNone()) {
+      return action;
+    }
+
+    if(res > 0) {
+      m_inData.set(m_buffer->getData(), res);
+      m_progress += res;
+    } else if(res == IOError::RETRY_READ || res == IOError::RETRY_WRITE) {
+      return repeat();
+    } else if(res == 0 || res == IOError::ZERO_VALUE) {
+      setInputEnded();
+    } else {
+      return error<AsyncIOError>("[oatpp::zlib::transferOverlappedAsync()]: Error. Failed to read data.", res);
+    }
+
+    return yieldTo(&OverlappedTransferCoroutine::process);
+
+  }
+
+  Action process() {
+
+    m_processRes = m_processor->iterate(m_inData, m_outData);
+
+    switch(m_processRes) {
+
+      case data::buffer::Processor::Error::PROVIDE_DATA_IN:
+        return yieldTo(&OverlappedTransferCoroutine::act);
+
+      case data::buffer::Processor::Error::FLUSH_DATA_OUT:
+        return yieldTo(&OverlappedTransferCoroutine::writeOutput);
+
+      case data::buffer::Processor::Error::FINISHED:
+        return finish();
+
+      default:
+        return error<AsyncIOError>("[oatpp::zlib::transferOverlappedAsync()]: Error. Processor error.", IOError::BROKEN_PIPE);
+
+    }
+
+  }
+
+  Action writeOutput() {
+
+    while(m_outData.bytesLeft > 0) {
+
+      async::Action action;
+      v_io_size res = m_writeCallback->write(m_outData.currBufferPtr, m_outData.bytesLeft, action);
+
+      if(res > 0) {
+        m_outData.inc(res);
+      }
+
+      if(!action.isNone()) {
+        /* the write is pending - let the processor work before waiting */
+        if(m_outData.bytesLeft > 0) {
+          processAhead();
+        }
+        return action;
+      }
+
+      if(res == IOError::RETRY_READ || res == IOError::RETRY_WRITE) {
+        processAhead();
+        return repeat();
+      }
+
+      if(res <= 0) {
+        return error<AsyncIOError>("[oatpp::zlib::transferOverlappedAsync()]: Error. Failed to write data.", res);
+      }
+
+    }
+
+    return yieldTo(&OverlappedTransferCoroutine::act);
+
+  }
+
+};
+
+}
+
+async::CoroutineStarter transferOverlappedAsync(const base::ObjectHandle<data::stream::ReadCallback>& readCallback,
+                                                const base::ObjectHandle<data::stream::WriteCallback>& writeCallback,
+                                                v_buff_size transferSize,
+                                                const base::ObjectHandle<data::buffer::IOBuffer>& buffer,
+                                                const base::ObjectHandle<data::buffer::Processor>& processor)
+{
+  return OverlappedTransferCoroutine::start(readCallback, writeCallback, transferSize, buffer, processor);
+}
+
+}}
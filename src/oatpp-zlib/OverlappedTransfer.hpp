@@ -0,0 +1,57 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#ifndef oatpp_zlib_OverlappedTransfer_hpp
+#define oatpp_zlib_OverlappedTransfer_hpp
+
+#include "oatpp/data/stream/Stream.hpp"
+#include "oatpp/data/buffer/IOBuffer.hpp"
+#include "oatpp/data/buffer/Processor.hpp"
+#include "oatpp/async/Coroutine.hpp"
+
+namespace oatpp { namespace zlib {
+
+/**
+ * Transfer data from `readCallback` to `writeCallback` through the processor asynchronously,
+ * overlapping processing with writes. <br>
+ * Same as `oatpp::data::stream::transferAsync()`, but while a write is pending (`writeCallback` returns an async action)
+ * the processor keeps being iterated with the pending `dataOut` before the coroutine waits. Processors with several output buffers
+ * (see &l:DeflateEncoder::setOutputBufferCount ();) compress input into free buffers in the meantime.
+ * Once the input is consumed, more input is read ahead if `readCallback` has it available without waiting.
+ * @param readCallback - &id:oatpp::data::stream::ReadCallback;.
+ * @param writeCallback - &id:oatpp::data::stream::WriteCallback;.
+ * @param transferSize - how much data should be read from the `readCallback`. `0` - to read until error.
+ * @param buffer - &id:oatpp::data::buffer::IOBuffer; used to read data from `readCallback`.
+ * @param processor - &id:oatpp::data::buffer::Processor;.
+ * @return - &id:oatpp::async::CoroutineStarter;.
+ */
+async::CoroutineStarter transferOverlappedAsync(const base::ObjectHandle<data::stream::ReadCallback>& readCallback,
+                                                const base::ObjectHandle<data::stream::WriteCallback>& writeCallback,
+                                                v_buff_size transferSize,
+                                                const base::ObjectHandle<data::buffer::IOBuffer>& buffer,
+                                                const base::ObjectHandle<data::buffer::Processor>& processor);
+
+}}
+
+#endif // oatpp_zlib_OverlappedTransfer_hpp
@@ -0,0 +1,409 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#include "PerMessageDeflate.hpp"
+#include "oatpp/base/Log.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <cstdlib>
+#include <vector>
+
+namespace oatpp { namespace zlib {
+
+namespace {
+
+  const v_char8 SYNC_FLUSH_TAIL[4] = {0x00, 0x00, 0xff, 0xff};
+
+  std::string trim(const std::string& str) {
+    v_buff_size begin = 0;
+    v_buff_size end = (v_buff_size) str.size();
+    while(begin < end && std::isspace((unsigned char) str[begin])) begin ++;
+    while(end > begin && std::isspace((unsigned char) str[end - 1])) end --;
+    return str.substr(begin, end - begin);
+  }
+
+  std::vector<std::string> split(const std::string& str, char separator) {
+    std::vector<std::string> result;
+    size_t pos = 0;
+    while(true) {
+      size_t end = str.find(separator, pos);
+      if(end == std::string::npos) {
+        result.push_back(trim(str.substr(pos)));
+        break;
+      }
+      result.push_back(trim(str.substr(pos, end - pos)));
+      pos = end + 1;
+    }
+    return result;
+  }
+
+  v_int32 clampWindowBits(v_int32 bits) {
+    /* zlib doesn't support 8-bit window for raw deflate - 9 is used instead */
+    if(bits < 9) return 9;
+    if(bits > 15) return 15;
+    return bits;
+  }
+
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// PerMessageDeflate::Config
+
+oatpp::String PerMessageDeflate::Config::toString() const {
+  std::string result = EXTENSION_NAME;
+  if(serverNoContextTakeover) {
+    result += "; server_no_context_takeover";
+  }
+  if(clientNoContextTakeover) {
+    result += "; client_no_context_takeover";
+  }
+  if(serverMaxWindowBits < 15) {
+    result += "; server_max_window_bits=" + std::to_string(serverMaxWindowBits);
+  }
+  if(clientMaxWindowBits < 15) {
+    result += "; client_max_window_bits=" + std::to_string(clientMaxWindowBits);
+  }
+  return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// PerMessageDeflate
+
+bool PerMessageDeflate::parseOffer(const std::string& offer, Config& config, bool& clientMaxWindowBitsOffered) {
+
+  auto params = split(offer, ';');
+
+  const std::string name = EXTENSION_NAME;
+  if(params[0].size() != name.size()) {
+    return false;
+  }
+  for(size_t i = 0; i < name.size(); i ++) {
+    if(std::tolower((unsigned char) params[0][i]) != name[i]) {
+      return false;
+    }
+  }
+
+  config = Config();
+  clientMaxWindowBitsOffered = false;
+
+  for(size_t i = 1; i < params.size(); i ++) {
+
+    std::string key = params[i];
+    std::string value;
+    bool hasValue = false;
+
+    auto eqPos = key.find('=');
+    if(eqPos != std::string::npos) {
+      value = trim(key.substr(eqPos + 1));
+      key = trim(key.substr(0, eqPos));
+      hasValue = true;
+      if(value.size() >= 2 && value.front() == '"' && value.back() == '"') {
+        value = value.substr(1, value.size() - 2);
+      }
+    }
+
+    v_int32 bits = 0;
+    if(hasValue) {
+      if(value.empty() || value.size() > 2 || !std::isdigit((unsigned char) value[0]) || value[0] == '0') {
+        return false;
+      }
+      char* end;
+      bits = (v_int32) std::strtol(value.c_str(), &end, 10);
+      if(*end != 0 || bits < 8 || bits > 15) {
+        return false;
+      }
+    }
+
+    if(key == "server_no_context_takeover" && !hasValue) {
+      config.serverNoContextTakeover = true;
+    } else if(key == "client_no_context_takeover" && !hasValue) {
+      config.clientNoContextTakeover = true;
+    } else if(key == "server_max_window_bits" && hasValue) {
+      config.serverMaxWindowBits = bits;
+    } else if(key == "client_max_window_bits") {
+      clientMaxWindowBitsOffered = true;
+      if(hasValue) {
+        config.clientMaxWindowBits = bits;
+      }
+    } else {
+      return false;
+    }
+
+  }
+
+  return true;
+
+}
+
+bool PerMessageDeflate::negotiate(const oatpp::String& offers, const Config& preferred, Config& agreed) {
+
+  if(!offers) {
+    return false;
+  }
+
+  for(auto& offer : split(*offers, ',')) {
+
+    Config config;
+    bool clientMaxWindowBitsOffered;
+    if(!parseOffer(offer, config, clientMaxWindowBitsOffered)) {
+      continue;
+    }
+
+    Config result;
+    result.serverNoContextTakeover = config.serverNoContextTakeover || preferred.serverNoContextTakeover;
+    result.clientNoContextTakeover = config.clientNoContextTakeover || preferred.clientNoContextTakeover;
+
+    result.serverMaxWindowBits = clampWindowBits(std::min(config.serverMaxWindowBits, preferred.serverMaxWindowBits));
+    if(result.serverMaxWindowBits > config.serverMaxWindowBits) {
+      /* client requested 8-bit window which can't be honored */
+      continue;
+    }
+
+    if(clientMaxWindowBitsOffered) {
+      result.clientMaxWindowBits = clampWindowBits(std::min(config.clientMaxWindowBits, preferred.clientMaxWindowBits));
+    }
+
+    agreed = result;
+    return true;
+
+  }
+
+  return false;
+
+}
+
+bool PerMessageDeflate::parseResponse(const oatpp::String& response, Config& agreed) {
+
+  if(!response) {
+    return false;
+  }
+
+  for(auto& extension : split(*response, ',')) {
+    Config config;
+    bool clientMaxWindowBitsOffered;
+    if(parseOffer(extension, config, clientMaxWindowBitsOffered)) {
+      if(config.clientMaxWindowBits < 9) {
+        return false;
+      }
+      agreed = config;
+      return true;
+    }
+  }
+
+  return false;
+
+}
+
+bool PerMessageDeflate::growBuffer(std::unique_ptr<v_char8[]>& buffer, v_buff_size& capacity, v_buff_size maxSize) {
+
+  v_buff_size newCapacity = capacity * 2;
+  if(maxSize > 0 && newCapacity > maxSize) {
+    newCapacity = maxSize;
+  }
+
+  if(newCapacity <= capacity) {
+    return false;
+  }
+
+  std::unique_ptr<v_char8[]> newBuffer(new v_char8[newCapacity]);
+  std::memcpy(newBuffer.get(), buffer.get(), capacity);
+  buffer = std::move(newBuffer);
+  capacity = newCapacity;
+
+  return true;
+
+}
+
+PerMessageDeflate::PerMessageDeflate(const Config& config,
+                                     bool isServer,
+                                     v_int32 compressionLevel,
+                                     v_buff_size maxMessageSize,
+                                     v_buff_size bufferSize)
+  : m_deflateNoContextTakeover(isServer ? config.serverNoContextTakeover : config.clientNoContextTakeover)
+  , m_inflateNoContextTakeover(isServer ? config.clientNoContextTakeover : config.serverNoContextTakeover)
+  , m_maxMessageSize(maxMessageSize)
+  , m_deflateBuffer(new v_char8[bufferSize])
+  , m_deflateBufferSize(bufferSize)
+  , m_inflateBuffer(new v_char8[bufferSize])
+  , m_inflateBufferSize(bufferSize)
+{
+
+  v_int32 deflateWindowBits = clampWindowBits(isServer ? config.serverMaxWindowBits : config.clientMaxWindowBits);
+  v_int32 inflateWindowBits = clampWindowBits(isServer ? config.clientMaxWindowBits : config.serverMaxWindowBits);
+
+  m_deflateStream.zalloc = Z_NULL;
+  m_deflateStream.zfree = Z_NULL;
+  m_deflateStream.opaque = Z_NULL;
+  m_deflateStream.next_in = nullptr;
+  m_deflateStream.avail_in = 0;
+
+  m_inflateStream.zalloc = Z_NULL;
+  m_inflateStream.zfree = Z_NULL;
+  m_inflateStream.opaque = Z_NULL;
+  m_inflateStream.next_in = nullptr;
+  m_inflateStream.avail_in = 0;
+
+  v_int32 res = deflateInit2(&m_deflateStream,
+                             compressionLevel,
+                             Z_DEFLATED,
+                             -deflateWindowBits,
+                             8 /* default memory */,
+                             Z_DEFAULT_STRATEGY);
+  if(res != Z_OK) {
+    OATPP_LOGe("[oatpp::zlib::PerMessageDeflate::PerMessageDeflate()]", "Error. Failed call to 'deflateInit2()'. Result {}", res)
+    throw std::runtime_error("[oatpp::zlib::PerMessageDeflate::PerMessageDeflate()]: Error. Can't init.");
+  }
+
+  res = inflateInit2(&m_inflateStream, -inflateWindowBits);
+  if(res != Z_OK) {
+    deflateEnd(&m_deflateStream);
+    OATPP_LOGe("[oatpp::zlib::PerMessageDeflate::PerMessageDeflate()]", "Error. Failed call to 'inflateInit2()'. Result {}", res)
+    throw std::runtime_error("[oatpp::zlib::PerMessageDeflate::PerMessageDeflate()]: Error. Can't init.");
+  }
+
+}
+
+PerMessageDeflate::~PerMessageDeflate() {
+  v_int32 res = deflateEnd(&m_deflateStream);
+  if(res != Z_OK && res != Z_DATA_ERROR) {
+    OATPP_LOGe("[oatpp::zlib::PerMessageDeflate::~PerMessageDeflate()]", "Error. Failed call to 'deflateEnd()'. Result {}", res)
+  }
+  res = inflateEnd(&m_inflateStream);
+  if(res != Z_OK) {
+    OATPP_LOGe("[oatpp::zlib::PerMessageDeflate::~PerMessageDeflate()]", "Error. Failed call to 'inflateEnd()'. Result {}", res)
+  }
+}
+
+v_int32 PerMessageDeflate::deflateMessage(const void* data, v_buff_size size, data::buffer::InlineWriteData& result) {
+
+  m_deflateStream.next_in = (Bytef *) data;
+  m_deflateStream.avail_in = (uInt) size;
+
+  v_buff_size outSize = 0;
+  int res = Z_OK;
+
+  while(res == Z_OK) {
+
+    if(outSize == m_deflateBufferSize) {
+      growBuffer(m_deflateBuffer, m_deflateBufferSize, 0);
+    }
+
+    m_deflateStream.next_out = (Bytef *) m_deflateBuffer.get() + outSize;
+    m_deflateStream.avail_out = (uInt) (m_deflateBufferSize - outSize);
+
+    res = deflate(&m_deflateStream, Z_SYNC_FLUSH);
+    outSize = m_deflateBufferSize - m_deflateStream.avail_out;
+
+    if(m_deflateStream.avail_out > 0) {
+      break;
+    }
+
+  }
+
+  if(res != Z_OK && res != Z_BUF_ERROR) {
+    deflateReset(&m_deflateStream);
+    result.set(nullptr, 0);
+    return ERROR_UNKNOWN;
+  }
+
+  if(outSize >= 4 && std::memcmp(m_deflateBuffer.get() + outSize - 4, SYNC_FLUSH_TAIL, 4) == 0) {
+    outSize -= 4;
+  }
+
+  if(outSize == 0) {
+    /* empty message is sent as a single 0x00 byte - RFC 7692 7.2.3.6 */
+    m_deflateBuffer[0] = 0;
+    outSize = 1;
+  }
+
+  if(m_deflateNoContextTakeover) {
+    deflateReset(&m_deflateStream);
+  }
+
+  result.set(m_deflateBuffer.get(), outSize);
+  return Z_OK;
+
+}
+
+v_int32 PerMessageDeflate::inflateMessage(const void* data, v_buff_size size, data::buffer::InlineWriteData& result) {
+
+  /* allow one byte over the limit to tell "exactly max size" from "too large" */
+  v_buff_size maxBufferSize = m_maxMessageSize > 0 ? m_maxMessageSize + 1 : 0;
+
+  v_buff_size outSize = 0;
+  int res = Z_OK;
+
+  const void* chunks[2] = {data, SYNC_FLUSH_TAIL};
+  v_buff_size chunkSizes[2] = {size, 4};
+
+  for(v_int32 i = 0; i < 2; i ++) {
+
+    m_inflateStream.next_in = (Bytef *) chunks[i];
+    m_inflateStream.avail_in = (uInt) chunkSizes[i];
+
+    do {
+
+      if(outSize == m_inflateBufferSize && !growBuffer(m_inflateBuffer, m_inflateBufferSize, maxBufferSize)) {
+        break;
+      }
+
+      m_inflateStream.next_out = (Bytef *) m_inflateBuffer.get() + outSize;
+      m_inflateStream.avail_out = (uInt) (m_inflateBufferSize - outSize);
+
+      res = inflate(&m_inflateStream, Z_SYNC_FLUSH);
+      outSize = m_inflateBufferSize - m_inflateStream.avail_out;
+
+    } while(res == Z_OK && (m_inflateStream.avail_in > 0 || m_inflateStream.avail_out == 0));
+
+    if(m_maxMessageSize > 0 && outSize > m_maxMessageSize) {
+      inflateReset(&m_inflateStream);
+      result.set(nullptr, 0);
+      return ERROR_MESSAGE_TOO_LARGE;
+    }
+
+    if(res == Z_STREAM_END) {
+      /* peer ended the deflate stream - the rest of input is ignored */
+      break;
+    }
+
+    if(res != Z_OK && res != Z_BUF_ERROR) {
+      inflateReset(&m_inflateStream);
+      result.set(nullptr, 0);
+      return ERROR_UNKNOWN;
+    }
+
+  }
+
+  if(res == Z_STREAM_END || m_inflateNoContextTakeover) {
+    inflateReset(&m_inflateStream);
+  }
+
+  result.set(m_inflateBuffer.get(), outSize);
+  return Z_OK;
+
+}
+
+}}
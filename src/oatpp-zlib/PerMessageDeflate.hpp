@@ -0,0 +1,158 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#ifndef oatpp_zlib_PerMessageDeflate_hpp
+#define oatpp_zlib_PerMessageDeflate_hpp
+
+#include "oatpp/data/buffer/Processor.hpp"
+#include "oatpp/Types.hpp"
+
+#include "zlib.h"
+#include <memory>
+
+namespace oatpp { namespace zlib {
+
+/**
+ * WebSocket permessage-deflate extension engine (RFC 7692). <br>
+ * Compresses/decompresses whole messages with raw deflate. Each message is ended with `Z_SYNC_FLUSH`
+ * and the `00 00 FF FF` tail is stripped on compression and restored on decompression. <br>
+ * Messages are processed into reusable buffers - no allocation is done per message once buffers have grown.
+ */
+class PerMessageDeflate {
+public:
+  static constexpr v_int32 ERROR_UNKNOWN = 100;
+  static constexpr v_int32 ERROR_MESSAGE_TOO_LARGE = 101;
+public:
+  static constexpr const char* const EXTENSION_NAME = "permessage-deflate";
+public:
+
+  /**
+   * Negotiated extension parameters.
+   */
+  struct Config {
+
+    /**
+     * LZ77 window of the server compressor. 9..15.
+     */
+    v_int32 serverMaxWindowBits = 15;
+
+    /**
+     * LZ77 window of the client compressor. 9..15.
+     */
+    v_int32 clientMaxWindowBits = 15;
+
+    /**
+     * Server resets its compression context after each message.
+     */
+    bool serverNoContextTakeover = false;
+
+    /**
+     * Client resets its compression context after each message.
+     */
+    bool clientNoContextTakeover = false;
+
+    /**
+     * Serialize as `Sec-WebSocket-Extensions` header value. Default parameters are omitted.
+     * @return - ex.: `permessage-deflate; server_no_context_takeover; server_max_window_bits=10`.
+     */
+    oatpp::String toString() const;
+
+  };
+
+private:
+  static bool parseOffer(const std::string& offer, Config& config, bool& clientMaxWindowBitsOffered);
+private:
+  static bool growBuffer(std::unique_ptr<v_char8[]>& buffer, v_buff_size& capacity, v_buff_size maxSize);
+private:
+  bool m_deflateNoContextTakeover;
+  bool m_inflateNoContextTakeover;
+  v_buff_size m_maxMessageSize;
+  z_stream m_deflateStream;
+  z_stream m_inflateStream;
+private:
+  std::unique_ptr<v_char8[]> m_deflateBuffer;
+  v_buff_size m_deflateBufferSize;
+  std::unique_ptr<v_char8[]> m_inflateBuffer;
+  v_buff_size m_inflateBufferSize;
+public:
+
+  /**
+   * Server-side negotiation. Pick the first acceptable permessage-deflate offer.
+   * @param offers - client `Sec-WebSocket-Extensions` header value.
+   * @param preferred - server preferences. Agreed windows won't exceed preferred ones and
+   * preferred no-context-takeover flags are always applied.
+   * @param agreed - out. Agreed parameters. Send `agreed.toString()` back to the client.
+   * @return - `true` if an offer was accepted.
+   */
+  static bool negotiate(const oatpp::String& offers, const Config& preferred, Config& agreed);
+
+  /**
+   * Client-side negotiation. Parse the server response.
+   * @param response - server `Sec-WebSocket-Extensions` header value.
+   * @param agreed - out. Agreed parameters.
+   * @return - `true` if the server accepted permessage-deflate with valid parameters.
+   */
+  static bool parseResponse(const oatpp::String& response, Config& agreed);
+
+public:
+
+  /**
+   * Constructor.
+   * @param config - negotiated parameters.
+   * @param isServer - `true` for the server side of the connection, `false` for the client side.
+   * @param compressionLevel
+   * @param maxMessageSize - max size of a decompressed message. Guards against decompression bombs.
+   * @param bufferSize - initial size of message buffers.
+   */
+  PerMessageDeflate(const Config& config,
+                    bool isServer,
+                    v_int32 compressionLevel = Z_DEFAULT_COMPRESSION,
+                    v_buff_size maxMessageSize = 16 * 1024 * 1024,
+                    v_buff_size bufferSize = 1024);
+
+  ~PerMessageDeflate();
+
+  /**
+   * Compress message.
+   * @param data - message payload.
+   * @param size - message payload size.
+   * @param result - out. Compressed payload. Valid until the next call to `deflateMessage`.
+   * @return - `Z_OK` on success or error code.
+   */
+  v_int32 deflateMessage(const void* data, v_buff_size size, data::buffer::InlineWriteData& result);
+
+  /**
+   * Decompress message.
+   * @param data - compressed payload of the whole message (payloads of all frames).
+   * @param size - compressed payload size.
+   * @param result - out. Decompressed message. Valid until the next call to `inflateMessage`.
+   * @return - `Z_OK` on success or error code.
+   */
+  v_int32 inflateMessage(const void* data, v_buff_size size, data::buffer::InlineWriteData& result);
+
+};
+
+}}
+
+#endif // oatpp_zlib_PerMessageDeflate_hpp
@@ -25,14 +25,212 @@
 #include "Processor.hpp"
 #include "oatpp/base/Log.hpp"
 
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
 namespace oatpp { namespace zlib {
 
+namespace {
+
+  v_int32 getWindowBits(Format format) {
+    switch(format) {
+      case Format::GZIP: return 15 | 16;
+      case Format::RAW: return -15;
+      default: return 15;
+    }
+  }
+
+  /* read size which is expected to produce about one output buffer at the observed ratio */
+  v_io_size getAdaptiveReadSize(v_buff_size bufferSize, uLong totalIn, uLong totalOut, v_buff_size minSize, v_buff_size maxSize) {
+    if(totalIn == 0 || totalOut == 0) {
+      return bufferSize;
+    }
+    v_buff_size size = (v_buff_size) ((double) bufferSize * (double) totalIn / (double) totalOut);
+    return std::min(std::max(size, minSize), maxSize);
+  }
+
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// OutputBufferRing
+
+OutputBufferRing::OutputBufferRing(v_buff_size bufferSize)
+  : m_buffers(1)
+  , m_capacities(1, 0)
+  , m_sizes(1, 0)
+  , m_bufferSize(bufferSize)
+  , m_activeCapacity(0)
+  , m_head(0)
+  , m_filled(0)
+  , m_handed(0)
+  , m_active(false)
+  , m_minSize(0)
+  , m_maxSize(0)
+  , m_fullCount(0)
+  , m_smallCount(0)
+{}
+
+v_int32 OutputBufferRing::getActiveIndex() const {
+  return (m_head + m_filled) % (v_int32) m_buffers.size();
+}
+
+void OutputBufferRing::setCount(v_int32 count) {
+
+  if(count < 1) {
+    throw std::runtime_error("[oatpp::zlib::OutputBufferRing::setCount()]: Error. Invalid buffer count.");
+  }
+
+  if(m_active || m_filled > 0 || m_handed > 0) {
+    throw std::runtime_error("[oatpp::zlib::OutputBufferRing::setCount()]: Error. Output is in progress.");
+  }
+
+  m_buffers.clear();
+  m_buffers.resize(count);
+  m_capacities.assign(count, 0);
+  m_sizes.assign(count, 0);
+  m_head = 0;
+
+}
+
+void OutputBufferRing::setAdaptiveSize(v_buff_size minSize, v_buff_size maxSize) {
+
+  if(minSize < 1 || maxSize < minSize) {
+    throw std::runtime_error("[oatpp::zlib::OutputBufferRing::setAdaptiveSize()]: Error. Invalid bounds.");
+  }
+
+  m_minSize = minSize;
+  m_maxSize = maxSize;
+  m_bufferSize = minSize;
+  m_fullCount = 0;
+  m_smallCount = 0;
+
+}
+
+v_buff_size OutputBufferRing::getBufferSize() const {
+  return m_bufferSize;
+}
+
+void OutputBufferRing::adaptSize(v_buff_size size, v_buff_size capacity) {
+
+  if(size == capacity) {
+    m_smallCount = 0;
+    /* output is larger than the buffer - grow */
+    if(++ m_fullCount >= 2 && m_bufferSize < m_maxSize) {
+      m_bufferSize = std::min(m_bufferSize * 2, m_maxSize);
+      m_fullCount = 0;
+    }
+  } else if(size < capacity / 4) {
+    m_fullCount = 0;
+    /* small output or frequent flushes - most of the buffer is wasted */
+    if(++ m_smallCount >= 4 && m_bufferSize > m_minSize) {
+      m_bufferSize = std::max(m_bufferSize / 2, m_minSize);
+      m_smallCount = 0;
+    }
+  } else {
+    m_fullCount = 0;
+    m_smallCount = 0;
+  }
+
+}
+
+bool OutputBufferRing::activate(z_stream& zStream) {
+
+  if(m_active && zStream.avail_out > 0) {
+    return true;
+  }
+
+  if(m_filled + m_handed >= (v_int32) m_buffers.size()) {
+    return false;
+  }
+
+  v_int32 index = getActiveIndex();
+  auto& buffer = m_buffers[index];
+  if(!buffer || m_capacities[index] != m_bufferSize) {
+    buffer.reset(new v_char8[m_bufferSize]);
+    m_capacities[index] = m_bufferSize;
+  }
+
+  zStream.next_out = (Bytef *) buffer.get();
+  zStream.avail_out = (uInt) m_bufferSize;
+  m_activeCapacity = m_bufferSize;
+  m_active = true;
+
+  return true;
+
+}
+
+v_buff_size OutputBufferRing::getActiveSize(const z_stream& zStream) const {
+  if(m_active) {
+    return m_activeCapacity - zStream.avail_out;
+  }
+  return 0;
+}
+
+void OutputBufferRing::commit(z_stream& zStream) {
+  v_buff_size size = m_activeCapacity - zStream.avail_out;
+  m_sizes[getActiveIndex()] = size;
+  m_filled ++;
+  m_active = false;
+  zStream.avail_out = 0;
+  if(m_maxSize > 0) {
+    adaptSize(size, m_activeCapacity);
+  }
+}
+
+void OutputBufferRing::close(z_stream& zStream) {
+  m_active = false;
+  zStream.avail_out = 0;
+}
+
+void OutputBufferRing::handOut(data::buffer::InlineReadData& dataOut) {
+  dataOut.set(m_buffers[m_head].get(), m_sizes[m_head]);
+  m_head = (m_head + 1) % (v_int32) m_buffers.size();
+  m_filled --;
+  m_handed ++;
+}
+
+void OutputBufferRing::handOutAll(std::vector<OutputSegment>& segments) {
+  while(m_filled > 0) {
+    segments.push_back({m_buffers[m_head].get(), m_sizes[m_head]});
+    m_head = (m_head + 1) % (v_int32) m_buffers.size();
+    m_filled --;
+    m_handed ++;
+  }
+}
+
+void OutputBufferRing::release() {
+  m_handed = 0;
+}
+
+v_int32 OutputBufferRing::getFilledCount() const {
+  return m_filled;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // DeflateEncoder
 
-DeflateEncoder::DeflateEncoder(v_buff_size bufferSize, bool gzip, v_int32 compressionLevel)
-  : m_buffer(new v_char8[bufferSize])
+DeflateEncoder::DeflateEncoder(v_buff_size bufferSize, Format format, v_int32 compressionLevel)
+  : m_ring(bufferSize)
   , m_bufferSize(bufferSize)
+  , m_minBufferSize(0)
+  , m_maxBufferSize(0)
+  , m_adaptive(false)
+  , m_compressionLevel(compressionLevel)
+  , m_mode(MODE_NORMAL)
+  , m_targetMode(MODE_NORMAL)
+  , m_storedWindowsCount(0)
+  , m_modeSwitchCount(0)
+  , m_windowIn(0)
+  , m_windowOut(0)
+  , m_stageCapacity(0)
+  , m_stageSize(0)
+  , m_inputStaged(false)
+  , m_flushRequested(false)
+  , m_format(format)
+  , m_hashAlgorithm(HashAlgorithm::NONE)
+  , m_hashFromStream(false)
+  , m_checksum(0)
   , m_finished(false)
 {
 
@@ -45,31 +243,24 @@ DeflateEncoder::DeflateEncoder(v_buff_size bufferSize, bool gzip, v_int32 compre
   m_zStream.next_out = nullptr;
   m_zStream.avail_out = 0;
 
-  v_int32 res;
-
-  if(gzip) {
-    res = deflateInit2(&m_zStream,
-                       compressionLevel,
-                       Z_DEFLATED,
-                       15 | 16,
-                       8 /* default memory */,
-                       Z_DEFAULT_STRATEGY);
-    if(res != Z_OK) {
-      OATPP_LOGe("[oatpp::zlib::DeflateEncoder::DeflateEncoder()]", "Error. Failed call to 'deflateInit2()'. Result {}", res)
-    }
-  } else {
-    res = deflateInit(&m_zStream, compressionLevel);
-    if(res != Z_OK) {
-      OATPP_LOGe("[oatpp::zlib::DeflateEncoder::DeflateEncoder()]", "Error. Failed call to 'deflateInit()'. Result {}", res)
-    }
-  }
+  v_int32 res = deflateInit2(&m_zStream,
+                             compressionLevel,
+                             Z_DEFLATED,
+                             getWindowBits(format),
+                             8 /* default memory */,
+                             Z_DEFAULT_STRATEGY);
 
   if(res != Z_OK) {
+    OATPP_LOGe("[oatpp::zlib::DeflateEncoder::DeflateEncoder()]", "Error. Failed call to 'deflateInit2()'. Result {}", res)
     throw std::runtime_error("[oatpp::zlib::DeflateEncoder::DeflateEncoder()]: Error. Can't init.");
   }
 
 }
 
+DeflateEncoder::DeflateEncoder(v_buff_size bufferSize, bool gzip, v_int32 compressionLevel)
+  : DeflateEncoder(bufferSize, gzip ? Format::GZIP : Format::ZLIB, compressionLevel)
+{}
+
 DeflateEncoder::~DeflateEncoder() {
   v_int32 res = deflateEnd(&m_zStream);
   if(res != Z_OK) {
@@ -78,105 +269,484 @@ DeflateEncoder::~DeflateEncoder() {
 }
 
 v_io_size DeflateEncoder::suggestInputStreamReadSize() {
+  if(m_stageCapacity > 0) {
+    /* reads of the staging size are passed to deflate() directly */
+    return m_stageCapacity;
+  }
+  if(m_maxBufferSize > 0) {
+    return getAdaptiveReadSize(m_ring.getBufferSize(), m_zStream.total_in, getTotalOut(), m_minBufferSize, m_maxBufferSize);
+  }
   return m_bufferSize;
 }
 
-v_int32 DeflateEncoder::iterate(data::buffer::InlineReadData& dataIn, data::buffer::InlineReadData& dataOut) {
+bool DeflateEncoder::fillInput(data::buffer::InlineReadData& dataIn) {
+
+  if(m_stageCapacity > 0 && dataIn.bytesLeft > 0 && (m_stageSize > 0 || dataIn.bytesLeft < m_stageCapacity)) {
+
+    v_buff_size size = m_stageCapacity - m_stageSize;
+    if(size > dataIn.bytesLeft) {
+      size = dataIn.bytesLeft;
+    }
+
+    std::memcpy(m_stage.get() + m_stageSize, dataIn.currBufferPtr, size);
+    m_stageSize += size;
+    updateContentHash(dataIn.currBufferPtr, size);
+    dataIn.inc(size);
+
+    if(m_stageSize < m_stageCapacity && !m_flushRequested) {
+      return false;
+    }
 
-  if(dataOut.bytesLeft > 0) {
-    return Error::FLUSH_DATA_OUT;
   }
 
-  if(m_finished){
-    dataOut.set(nullptr, 0);
-    return Error::FINISHED;
+  if(m_stageSize > 0) {
+    m_zStream.next_in = (Bytef *) m_stage.get();
+    m_zStream.avail_in = (uInt) m_stageSize;
+    m_stageSize = 0;
+    m_inputStaged = true;
+    return true;
+  }
+
+  if(dataIn.bytesLeft > 0) {
+    m_zStream.next_in = (Bytef *) dataIn.currBufferPtr;
+    m_zStream.avail_in = (uInt) dataIn.bytesLeft;
+    m_inputStaged = false;
+    return true;
+  }
+
+  return false;
+
+}
+
+void DeflateEncoder::setOutputBufferCount(v_int32 count) {
+  m_ring.setCount(count);
+}
+
+void DeflateEncoder::setInputCoalescing(v_buff_size threshold) {
+
+  if(m_stageSize > 0 || (m_inputStaged && m_zStream.avail_in > 0)) {
+    throw std::runtime_error("[oatpp::zlib::DeflateEncoder::setInputCoalescing()]: Error. Input is being staged.");
+  }
+
+  m_stage.reset(threshold > 0 ? new v_char8[threshold] : nullptr);
+  m_stageCapacity = threshold;
+  m_inputStaged = false;
+
+}
+
+void DeflateEncoder::setAdaptiveBufferSize(v_buff_size minSize, v_buff_size maxSize) {
+  m_ring.setAdaptiveSize(minSize, maxSize);
+  m_minBufferSize = minSize;
+  m_maxBufferSize = maxSize;
+}
+
+v_buff_size DeflateEncoder::getOutputBufferSize() const {
+  return m_ring.getBufferSize();
+}
+
+void DeflateEncoder::flush() {
+  m_flushRequested = true;
+}
+
+void DeflateEncoder::setAdaptiveStrategy(const AdaptiveStrategy& strategy) {
+  m_adaptive = true;
+  m_adaptiveStrategy = strategy;
+  m_windowIn = m_zStream.total_in;
+  m_windowOut = getTotalOut();
+}
+
+v_int32 DeflateEncoder::getStrategyMode() const {
+  return m_mode;
+}
+
+v_int64 DeflateEncoder::getStrategyModeSwitchCount() const {
+  return m_modeSwitchCount;
+}
+
+void DeflateEncoder::setContentHash(HashAlgorithm algorithm) {
+
+  if(m_zStream.total_in > 0 || m_stageSize > 0 || m_zStream.avail_in > 0) {
+    throw std::runtime_error("[oatpp::zlib::DeflateEncoder::setContentHash()]: Error. Input is already processed.");
+  }
+
+  m_hashAlgorithm = algorithm;
+  m_hashFromStream = (algorithm == HashAlgorithm::CRC32 && m_format == Format::GZIP) ||
+                     (algorithm == HashAlgorithm::ADLER32 && m_format == Format::ZLIB);
+
+  switch(algorithm) {
+    case HashAlgorithm::CRC32: m_checksum = crc32(0L, Z_NULL, 0); break;
+    case HashAlgorithm::ADLER32: m_checksum = adler32(0L, Z_NULL, 0); break;
+    case HashAlgorithm::XXHASH64: m_xxHash.reset(); break;
+    default: break;
+  }
+
+}
+
+void DeflateEncoder::updateContentHash(const void* data, v_buff_size size) {
+
+  if(m_hashFromStream || size <= 0) {
+    return;
+  }
+
+  switch(m_hashAlgorithm) {
+    case HashAlgorithm::CRC32: m_checksum = crc32(m_checksum, (const Bytef *) data, (uInt) size); break;
+    case HashAlgorithm::ADLER32: m_checksum = adler32(m_checksum, (const Bytef *) data, (uInt) size); break;
+    case HashAlgorithm::XXHASH64: m_xxHash.update(data, size); break;
+    default: break;
+  }
+
+}
+
+v_uint64 DeflateEncoder::getContentHash() const {
+
+  if(m_hashFromStream) {
+    /* zlib keeps the checksum of the consumed input in 'adler' - crc32 for gzip, adler32 for zlib */
+    return m_zStream.adler;
+  }
+
+  switch(m_hashAlgorithm) {
+    case HashAlgorithm::CRC32:
+    case HashAlgorithm::ADLER32:
+      return m_checksum;
+    case HashAlgorithm::XXHASH64:
+      return m_xxHash.digest();
+    default:
+      return 0;
+  }
+
+}
+
+v_int64 DeflateEncoder::getContentSize() const {
+  return (v_int64) m_zStream.total_in;
+}
+
+oatpp::String DeflateEncoder::getETag() const {
+  if(m_hashAlgorithm == HashAlgorithm::NONE) {
+    return nullptr;
   }
+  char etag[48];
+  std::snprintf(etag, sizeof(etag), "W/\"%016llx-%lld\"", (unsigned long long) getContentHash(), (long long) getContentSize());
+  return oatpp::String(etag);
+}
+
+uLong DeflateEncoder::getTotalOut() {
+  /* count output which is compressed but not yet copied to the buffer */
+  unsigned pending = 0;
+  deflatePending(&m_zStream, &pending, Z_NULL);
+  return m_zStream.total_out + pending;
+}
+
+v_int32 DeflateEncoder::applyStrategyMode() {
+
+  v_int32 level = m_compressionLevel;
+  v_int32 strategy = Z_DEFAULT_STRATEGY;
+
+  switch(m_targetMode) {
+    case MODE_HUFFMAN_ONLY: level = Z_BEST_SPEED; strategy = Z_HUFFMAN_ONLY; break;
+    case MODE_STORED: level = Z_NO_COMPRESSION; break;
+    default: break;
+  }
+
+  /* deflateParams() compresses pending input with old parameters - keep client input out of it */
+  auto nextIn = m_zStream.next_in;
+  auto availIn = m_zStream.avail_in;
+  m_zStream.next_in = nullptr;
+  m_zStream.avail_in = 0;
+
+  v_int32 res = deflateParams(&m_zStream, level, strategy);
+
+  m_zStream.next_in = nextIn;
+  m_zStream.avail_in = availIn;
+
+  if(res == Z_OK) {
+    m_mode = m_targetMode;
+    m_modeSwitchCount ++;
+    m_windowIn = m_zStream.total_in;
+    m_windowOut = getTotalOut();
+  } else if(res == Z_BUF_ERROR) {
+    /* not enough output space - retry after the output is flushed */
+    res = Z_OK;
+  }
+
+  return res;
+
+}
+
+v_int32 DeflateEncoder::completeBlock() {
+
+  /* keep client input out of the block, same as for deflateParams() */
+  auto nextIn = m_zStream.next_in;
+  auto availIn = m_zStream.avail_in;
+  m_zStream.next_in = nullptr;
+  m_zStream.avail_in = 0;
+
+  v_int32 res = deflate(&m_zStream, Z_BLOCK);
+
+  m_zStream.next_in = nextIn;
+  m_zStream.avail_in = availIn;
+
+  if(res == Z_BUF_ERROR) {
+    /* nothing to complete - already at a block boundary */
+    res = Z_OK;
+  }
+
+  return res;
+
+}
+
+v_int32 DeflateEncoder::adaptStrategy() {
+
+  if(m_mode != m_targetMode) {
+    return applyStrategyMode();
+  }
+
+  uLong in = m_zStream.total_in - m_windowIn;
+  if((v_buff_size) in < m_adaptiveStrategy.windowSize) {
+    return Z_OK;
+  }
+
+  /* symbols of the current block are not in the output yet - complete the block before measuring */
+  v_int32 res = completeBlock();
+  if(res != Z_OK || m_zStream.avail_out == 0) {
+    /* no output space - measure after the output is flushed */
+    return res;
+  }
+
+  uLong out = getTotalOut();
+  v_float64 ratio = (v_float64) (out - m_windowOut) / in;
+
+  m_windowIn = m_zStream.total_in;
+  m_windowOut = out;
+
+  switch(m_mode) {
+
+    case MODE_NORMAL:
+      if(ratio >= m_adaptiveStrategy.incompressibleRatio) {
+        m_targetMode = MODE_HUFFMAN_ONLY;
+      }
+      break;
+
+    case MODE_HUFFMAN_ONLY:
+      if(ratio < m_adaptiveStrategy.compressibleRatio) {
+        m_targetMode = MODE_NORMAL;
+      } else if(ratio >= m_adaptiveStrategy.incompressibleRatio) {
+        m_targetMode = MODE_STORED;
+        m_storedWindowsCount = 0;
+      }
+      break;
+
+    case MODE_STORED:
+      /* stored data tells nothing about compressibility - probe it periodically */
+      if(++ m_storedWindowsCount >= m_adaptiveStrategy.storedWindows) {
+        m_targetMode = MODE_HUFFMAN_ONLY;
+      }
+      break;
+
+    default:
+      break;
+
+  }
+
+  if(m_mode != m_targetMode) {
+    return applyStrategyMode();
+  }
+
+  return Z_OK;
+
+}
+
+v_int32 DeflateEncoder::process(data::buffer::InlineReadData& dataIn, bool fillAll) {
 
   if(dataIn.currBufferPtr != nullptr) {
 
-    if(dataIn.bytesLeft == 0) {
-      return Error::PROVIDE_DATA_IN;
-    }
+    while(true) {
+
+      if(m_zStream.avail_in == 0 && !fillInput(dataIn) && !m_flushRequested) {
+        return Error::PROVIDE_DATA_IN;
+      }
+
+      if(!m_ring.activate(m_zStream)) {
+        /* all buffers are in use - output has to be consumed first */
+        return Error::FLUSH_DATA_OUT;
+      }
+
+      /* sync flush once all the input provided so far is passed to deflate */
+      int flush = Z_NO_FLUSH;
+      if(m_flushRequested && (!m_inputStaged || dataIn.bytesLeft == 0)) {
+        flush = Z_SYNC_FLUSH;
+      }
+
+      bool flushed = false;
+      v_buff_size availIn = m_zStream.avail_in;
+
+      int res = Z_OK;
+      while(res == Z_OK && m_zStream.avail_out > 0 && (m_zStream.avail_in > 0 || flush == Z_SYNC_FLUSH)) {
+        if(m_adaptive) {
+          res = adaptStrategy();
+          if(res != Z_OK || m_zStream.avail_out == 0) {
+            break;
+          }
+        }
+        res = deflate(&m_zStream, flush);
+        if(flush == Z_SYNC_FLUSH && m_zStream.avail_in == 0 && m_zStream.avail_out > 0) {
+          m_flushRequested = false;
+          flushed = true;
+          break;
+        }
+      }
+
+      if(!m_inputStaged) {
+        updateContentHash(dataIn.currBufferPtr, availIn - m_zStream.avail_in);
+        dataIn.inc(availIn - m_zStream.avail_in);
+      }
+
+      if(res != Z_BUF_ERROR && res != Z_OK) {
+        m_finished = true;
+        return ERROR_UNKNOWN;
+      }
+
+      if(m_zStream.avail_out == 0 || (flushed && m_ring.getActiveSize(m_zStream) > 0)) {
+        m_ring.commit(m_zStream);
+        if(!fillAll || flushed) {
+          return Error::FLUSH_DATA_OUT;
+        }
+      }
 
-    if(m_zStream.avail_out == 0) {
-      m_zStream.next_out = (Bytef *) m_buffer.get();
-      m_zStream.avail_out = (uInt) m_bufferSize;
     }
 
-    if(m_zStream.avail_in == 0) {
-      m_zStream.next_in = (Bytef *) dataIn.currBufferPtr;
-      m_zStream.avail_in = (uInt) dataIn.bytesLeft;
+  }
+
+  if(m_stageSize > 0) {
+    m_zStream.next_in = (Bytef *) m_stage.get();
+    m_zStream.avail_in = (uInt) m_stageSize;
+    m_stageSize = 0;
+    m_inputStaged = true;
+  } else if(!m_inputStaged) {
+    m_zStream.next_in = nullptr;
+    m_zStream.avail_in = 0;
+  }
+
+  while(true) {
+
+    if(!m_ring.activate(m_zStream)) {
+      return Error::FLUSH_DATA_OUT;
     }
 
     int res = Z_OK;
-    while(res == Z_OK && m_zStream.avail_in > 0 && m_zStream.avail_out > 0) {
-      res = deflate(&m_zStream, Z_NO_FLUSH);
+    while(res == Z_OK && m_zStream.avail_out > 0) {
+      res = deflate(&m_zStream, Z_FINISH);
     }
 
-    if(m_zStream.avail_in < dataIn.bytesLeft) {
-      dataIn.inc(dataIn.bytesLeft - m_zStream.avail_in);
-    }
+    if(res == Z_STREAM_END) {
 
-    if(res != Z_BUF_ERROR && res != Z_OK) {
       m_finished = true;
-      dataOut.set(nullptr, 0);
+
+      if(m_ring.getActiveSize(m_zStream) > 0) {
+        m_ring.commit(m_zStream);
+      } else {
+        m_ring.close(m_zStream);
+      }
+
+      return Error::FINISHED;
+
+    } else if(res == Z_OK && m_zStream.avail_out == 0) {
+
+      m_ring.commit(m_zStream);
+      if(!fillAll) {
+        return Error::FLUSH_DATA_OUT;
+      }
+
+    } else {
       return ERROR_UNKNOWN;
     }
 
-    if(m_zStream.avail_out == 0) {
-      dataOut.set(m_buffer.get(), m_bufferSize);
+  }
+
+}
+
+v_int32 DeflateEncoder::iterate(data::buffer::InlineReadData& dataIn, data::buffer::InlineReadData& dataOut) {
+
+  bool outBusy = dataOut.bytesLeft > 0;
+
+  if(!outBusy) {
+    m_ring.release();
+    if(m_ring.getFilledCount() > 0) {
+      m_ring.handOut(dataOut);
       return Error::FLUSH_DATA_OUT;
     }
+  }
 
-    if(dataIn.bytesLeft == 0) {
-      return Error::PROVIDE_DATA_IN;
+  if(m_finished){
+    if(outBusy) {
+      return Error::FLUSH_DATA_OUT;
     }
+    dataOut.set(nullptr, 0);
+    return Error::FINISHED;
+  }
 
-    return ERROR_UNKNOWN;
+  /* while dataOut is still in use compress ahead into free buffers */
+  v_int32 res = process(dataIn, outBusy);
 
+  if(res == ERROR_UNKNOWN) {
+    if(!outBusy) {
+      dataOut.set(nullptr, 0);
+    }
+    return res;
   }
 
-  m_zStream.next_in = nullptr;
-  m_zStream.avail_in = 0;
+  if(outBusy) {
+    return Error::FLUSH_DATA_OUT;
+  }
 
-  if(m_zStream.avail_out == 0) {
-    m_zStream.next_out = (Bytef *) m_buffer.get();
-    m_zStream.avail_out = (uInt) m_bufferSize;
+  if(m_ring.getFilledCount() > 0) {
+    m_ring.handOut(dataOut);
+    return Error::FLUSH_DATA_OUT;
   }
 
-  int res = Z_OK;
-  while(res == Z_OK && m_zStream.avail_out > 0) {
-    res = deflate(&m_zStream, Z_FINISH);
+  if(res == Error::FINISHED) {
+    dataOut.set(nullptr, 0);
   }
 
-  if(res == Z_STREAM_END) {
+  return res;
 
-    m_finished = true;
+}
 
-    if(m_zStream.avail_out < m_bufferSize) {
-      dataOut.set(m_buffer.get(), m_bufferSize - m_zStream.avail_out);
-      return Error::FLUSH_DATA_OUT;
-    } else {
-      dataOut.set(nullptr, 0);
-      return Error::FINISHED;
+v_int32 DeflateEncoder::iterateVectored(data::buffer::InlineReadData& dataIn, std::vector<OutputSegment>& segments) {
+
+  m_ring.release();
+  segments.clear();
+
+  v_int32 res = Error::FINISHED;
+  if(!m_finished) {
+    res = process(dataIn, true);
+    if(res == ERROR_UNKNOWN || res == Error::PROVIDE_DATA_IN) {
+      /* filled buffers are held until all of them are filled or a flush point is reached */
+      return res;
     }
+  }
 
-  } else if(res == Z_OK && m_zStream.avail_out == 0) {
-    dataOut.set(m_buffer.get(), m_bufferSize);
+  m_ring.handOutAll(segments);
+  if(!segments.empty()) {
     return Error::FLUSH_DATA_OUT;
   }
 
-  return ERROR_UNKNOWN;
+  return res;
 
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // DeflateDecoder
 
-DeflateDecoder::DeflateDecoder(v_buff_size bufferSize, bool gzip)
-  : m_buffer(new v_char8[bufferSize])
+DeflateDecoder::DeflateDecoder(v_buff_size bufferSize, Format format)
+  : m_ring(bufferSize)
   , m_bufferSize(bufferSize)
+  , m_minBufferSize(0)
+  , m_maxBufferSize(0)
+  , m_multiMember(format == Format::GZIP)
+  , m_memberEnded(false)
   , m_finished(false)
+  , m_membersIn(0)
+  , m_membersOut(0)
 {
 
   m_zStream.zalloc = Z_NULL;
@@ -188,26 +758,19 @@ DeflateDecoder::DeflateDecoder(v_buff_size bufferSize, bool gzip)
   m_zStream.next_out = nullptr;
   m_zStream.avail_out = 0;
 
-  v_int32 res;
-
-  if(gzip) {
-    res = inflateInit2(&m_zStream, 15 | 16);
-    if(res != Z_OK) {
-      OATPP_LOGe("[oatpp::zlib::DeflateDecoder::DeflateDecoder()]", "Error. Failed call to 'inflateInit2()'. Result {}", res)
-    }
-  } else {
-    res = inflateInit(&m_zStream);
-    if(res != Z_OK) {
-      OATPP_LOGe("[oatpp::zlib::DeflateDecoder::DeflateDecoder()]", "Error. Failed call to 'inflateInit()'. Result {}", res)
-    }
-  }
+  v_int32 res = inflateInit2(&m_zStream, getWindowBits(format));
 
   if(res != Z_OK) {
+    OATPP_LOGe("[oatpp::zlib::DeflateDecoder::DeflateDecoder()]", "Error. Failed call to 'inflateInit2()'. Result {}", res)
     throw std::runtime_error("[oatpp::zlib::DeflateDecoder::DeflateDecoder()]: Error. Can't init.");
   }
 
 }
 
+DeflateDecoder::DeflateDecoder(v_buff_size bufferSize, bool gzip)
+  : DeflateDecoder(bufferSize, gzip ? Format::GZIP : Format::ZLIB)
+{}
+
 DeflateDecoder::~DeflateDecoder() {
   v_int32 res = inflateEnd(&m_zStream);
   if(res != Z_OK) {
@@ -216,96 +779,249 @@ DeflateDecoder::~DeflateDecoder() {
 }
 
 v_io_size DeflateDecoder::suggestInputStreamReadSize() {
+  if(m_maxBufferSize > 0) {
+    return getAdaptiveReadSize(m_ring.getBufferSize(), m_membersIn + m_zStream.total_in, m_membersOut + m_zStream.total_out,
+                               m_minBufferSize, m_maxBufferSize);
+  }
   return m_bufferSize;
 }
 
-v_int32 DeflateDecoder::iterate(data::buffer::InlineReadData& dataIn, data::buffer::InlineReadData& dataOut) {
+void DeflateDecoder::setOutputBufferCount(v_int32 count) {
+  m_ring.setCount(count);
+}
 
+void DeflateDecoder::setAdaptiveBufferSize(v_buff_size minSize, v_buff_size maxSize) {
+  m_ring.setAdaptiveSize(minSize, maxSize);
+  m_minBufferSize = minSize;
+  m_maxBufferSize = maxSize;
+}
 
-  if(dataOut.bytesLeft > 0) {
-    return Error::FLUSH_DATA_OUT;
-  }
+v_buff_size DeflateDecoder::getOutputBufferSize() const {
+  return m_ring.getBufferSize();
+}
 
-  if(m_finished){
-    dataOut.set(nullptr, 0);
-    return Error::FINISHED;
-  }
+v_int32 DeflateDecoder::process(data::buffer::InlineReadData& dataIn, bool fillAll) {
 
   if(dataIn.currBufferPtr != nullptr) {
 
-    if(dataIn.bytesLeft == 0) {
-      return Error::PROVIDE_DATA_IN;
-    }
+    while(true) {
+
+      if(dataIn.bytesLeft == 0) {
+        return Error::PROVIDE_DATA_IN;
+      }
+
+      if(!m_ring.activate(m_zStream)) {
+        /* all buffers are in use - output has to be consumed first */
+        return Error::FLUSH_DATA_OUT;
+      }
+
+      if(m_zStream.avail_in == 0) {
+        m_zStream.next_in = (Bytef *) dataIn.currBufferPtr;
+        m_zStream.avail_in = (uInt) dataIn.bytesLeft;
+      }
+
+      int res = Z_OK;
+      while(res == Z_OK && m_zStream.avail_in > 0 && m_zStream.avail_out > 0) {
+        if(m_memberEnded) {
+          /* more input after the end of a gzip member - next member follows */
+          m_membersIn += m_zStream.total_in;
+          m_membersOut += m_zStream.total_out;
+          res = inflateReset(&m_zStream);
+          m_memberEnded = false;
+          if(res != Z_OK) {
+            break;
+          }
+        }
+        res = inflate(&m_zStream, Z_NO_FLUSH);
+        if(res == Z_STREAM_END && m_multiMember) {
+          m_memberEnded = true;
+          res = Z_OK;
+        }
+      }
+
+      if(m_zStream.avail_in < dataIn.bytesLeft) {
+        dataIn.inc(dataIn.bytesLeft - m_zStream.avail_in);
+      }
+
+      if(res != Z_BUF_ERROR && res != Z_OK && res != Z_STREAM_END) {
+        m_finished = true;
+        return ERROR_UNKNOWN;
+      }
+
+      if(m_zStream.avail_out == 0) {
+        m_ring.commit(m_zStream);
+        if(!fillAll) {
+          return Error::FLUSH_DATA_OUT;
+        }
+        continue;
+      }
+
+      if(dataIn.bytesLeft == 0) {
+        return Error::PROVIDE_DATA_IN;
+      }
+
+      return ERROR_UNKNOWN;
 
-    if(m_zStream.avail_out == 0) {
-      m_zStream.next_out = (Bytef *) m_buffer.get();
-      m_zStream.avail_out = (uInt) m_bufferSize;
     }
 
-    if(m_zStream.avail_in == 0) {
-      m_zStream.next_in = (Bytef *) dataIn.currBufferPtr;
-      m_zStream.avail_in = (uInt) dataIn.bytesLeft;
+  }
+
+  m_zStream.next_in = nullptr;
+  m_zStream.avail_in = 0;
+
+  while(true) {
+
+    if(!m_ring.activate(m_zStream)) {
+      return Error::FLUSH_DATA_OUT;
     }
 
     int res = Z_OK;
-    while(res == Z_OK && m_zStream.avail_in > 0 && m_zStream.avail_out > 0) {
-      res = inflate(&m_zStream, Z_NO_FLUSH);
+    while(res == Z_OK && m_zStream.avail_out > 0) {
+      res = inflate(&m_zStream, Z_FINISH);
     }
 
-    if(m_zStream.avail_in < dataIn.bytesLeft) {
-      dataIn.inc(dataIn.bytesLeft - m_zStream.avail_in);
-    }
+    if(res == Z_STREAM_END) {
 
-    if(res != Z_BUF_ERROR && res != Z_OK && res != Z_STREAM_END) {
       m_finished = true;
-      dataOut.set(nullptr, 0);
+
+      if(m_ring.getActiveSize(m_zStream) > 0) {
+        m_ring.commit(m_zStream);
+      } else {
+        m_ring.close(m_zStream);
+      }
+
+      return Error::FINISHED;
+
+    } else if(res == Z_OK && m_zStream.avail_out == 0) {
+
+      m_ring.commit(m_zStream);
+      if(!fillAll) {
+        return Error::FLUSH_DATA_OUT;
+      }
+
+    } else {
       return ERROR_UNKNOWN;
     }
 
-    if(m_zStream.avail_out == 0) {
-      dataOut.set(m_buffer.get(), m_bufferSize);
+  }
+
+}
+
+v_int32 DeflateDecoder::iterate(data::buffer::InlineReadData& dataIn, data::buffer::InlineReadData& dataOut) {
+
+  bool outBusy = dataOut.bytesLeft > 0;
+
+  if(!outBusy) {
+    m_ring.release();
+    if(m_ring.getFilledCount() > 0) {
+      m_ring.handOut(dataOut);
       return Error::FLUSH_DATA_OUT;
     }
+  }
 
-    if(dataIn.bytesLeft == 0) {
-      return Error::PROVIDE_DATA_IN;
+  if(m_finished){
+    if(outBusy) {
+      return Error::FLUSH_DATA_OUT;
     }
+    dataOut.set(nullptr, 0);
+    return Error::FINISHED;
+  }
 
-    return ERROR_UNKNOWN;
+  /* while dataOut is still in use decompress ahead into free buffers */
+  v_int32 res = process(dataIn, outBusy);
 
+  if(res == ERROR_UNKNOWN) {
+    if(!outBusy) {
+      dataOut.set(nullptr, 0);
+    }
+    return res;
   }
 
-  m_zStream.next_in = nullptr;
-  m_zStream.avail_in = 0;
+  if(outBusy) {
+    return Error::FLUSH_DATA_OUT;
+  }
 
-  if(m_zStream.avail_out == 0) {
-    m_zStream.next_out = (Bytef *) m_buffer.get();
-    m_zStream.avail_out = (uInt) m_bufferSize;
+  if(m_ring.getFilledCount() > 0) {
+    m_ring.handOut(dataOut);
+    return Error::FLUSH_DATA_OUT;
   }
 
-  int res = Z_OK;
-  while(res == Z_OK && m_zStream.avail_out > 0) {
-    res = inflate(&m_zStream, Z_FINISH);
+  if(res == Error::FINISHED) {
+    dataOut.set(nullptr, 0);
   }
 
-  if(res == Z_STREAM_END) {
+  return res;
 
-    m_finished = true;
+}
 
-    if(m_zStream.avail_out < m_bufferSize) {
-      dataOut.set(m_buffer.get(), m_bufferSize - m_zStream.avail_out);
-      return Error::FLUSH_DATA_OUT;
-    } else {
-      dataOut.set(nullptr, 0);
-      return Error::FINISHED;
+v_int32 DeflateDecoder::iterateVectored(data::buffer::InlineReadData& dataIn, std::vector<OutputSegment>& segments) {
+
+  m_ring.release();
+  segments.clear();
+
+  v_int32 res = Error::FINISHED;
+  if(!m_finished) {
+    res = process(dataIn, true);
+    if(res == ERROR_UNKNOWN || res == Error::PROVIDE_DATA_IN) {
+      /* filled buffers are held until all of them are filled or the stream is finished */
+      return res;
+    }
+  }
+
+  m_ring.handOutAll(segments);
+  if(!segments.empty()) {
+    return Error::FLUSH_DATA_OUT;
+  }
+
+  return res;
+
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// PassThroughProcessor
+
+PassThroughProcessor::PassThroughProcessor(v_buff_size bufferSize)
+  : m_bufferSize(bufferSize)
+  , m_outSize(0)
+  , m_finished(false)
+{}
+
+v_io_size PassThroughProcessor::suggestInputStreamReadSize() {
+  return m_bufferSize;
+}
+
+v_int32 PassThroughProcessor::iterate(data::buffer::InlineReadData& dataIn, data::buffer::InlineReadData& dataOut) {
+
+  if(dataOut.bytesLeft > 0) {
+    return Error::FLUSH_DATA_OUT;
+  }
+
+  /* input handed out as output is consumed only now - the client must not reuse it while output is pending */
+  if(m_outSize > 0) {
+    dataIn.inc(m_outSize);
+    m_outSize = 0;
+  }
+
+  if(m_finished){
+    dataOut.set(nullptr, 0);
+    return Error::FINISHED;
+  }
+
+  if(dataIn.currBufferPtr != nullptr) {
+
+    if(dataIn.bytesLeft == 0) {
+      return Error::PROVIDE_DATA_IN;
     }
 
-  } else if(res == Z_OK && m_zStream.avail_out == 0) {
-    dataOut.set(m_buffer.get(), m_bufferSize);
+    dataOut.set(dataIn.currBufferPtr, dataIn.bytesLeft);
+    m_outSize = dataIn.bytesLeft;
     return Error::FLUSH_DATA_OUT;
+
   }
 
-  return ERROR_UNKNOWN;
+  m_finished = true;
+  dataOut.set(nullptr, 0);
+  return Error::FINISHED;
 
 }
 
@@ -25,22 +25,241 @@
 #ifndef oatpp_zlib_Processor_hpp
 #define oatpp_zlib_Processor_hpp
 
+#include "Vectored.hpp"
+#include "Hash.hpp"
+
 #include "oatpp/data/buffer/Processor.hpp"
+#include "oatpp/Types.hpp"
 
 #include "zlib.h"
 #include <memory>
+#include <vector>
 
 namespace oatpp { namespace zlib {
 
+/**
+ * Deflate stream format.
+ */
+enum class Format : v_int32 {
+
+  /**
+   * Zlib-wrapped deflate. Adler32 checksum. Used by "deflate" content encoding.
+   */
+  ZLIB = 0,
+
+  /**
+   * Gzip. CRC32 checksum. Used by "gzip" content encoding.
+   */
+  GZIP = 1,
+
+  /**
+   * Raw deflate. No header, no checksum - use it for links which are already integrity-protected (ex.: TLS).
+   */
+  RAW = 2
+
+};
+
+/**
+ * Ring of output buffers used by &l:DeflateEncoder; and &l:DeflateDecoder;. <br>
+ * zlib writes to the active buffer. Filled buffers are handed out to the client in the same order.
+ * A buffer is allocated on its first use and reallocated when the buffer size changes.
+ */
+class OutputBufferRing {
+private:
+  std::vector<std::unique_ptr<v_char8[]>> m_buffers;
+  std::vector<v_buff_size> m_capacities;
+  std::vector<v_buff_size> m_sizes;
+  v_buff_size m_bufferSize;
+  v_buff_size m_activeCapacity;
+  v_int32 m_head;
+  v_int32 m_filled;
+  v_int32 m_handed;
+  bool m_active;
+private:
+  v_buff_size m_minSize;
+  v_buff_size m_maxSize;
+  v_int32 m_fullCount;
+  v_int32 m_smallCount;
+private:
+  v_int32 getActiveIndex() const;
+  void adaptSize(v_buff_size size, v_buff_size capacity);
+public:
+
+  /**
+   * Constructor.
+   * @param bufferSize - size of each buffer.
+   */
+  OutputBufferRing(v_buff_size bufferSize);
+
+  /**
+   * Set number of buffers. Throws if the output is in progress.
+   * @param count
+   */
+  void setCount(v_int32 count);
+
+  /**
+   * Let the buffer size follow the output pattern within bounds. <br>
+   * Buffer size is doubled after consecutive buffers are filled completely (large output)
+   * and halved after consecutive buffers are committed less than a quarter full (small responses, frequent flushes).
+   * Starts from `minSize`. New size applies to buffers taken after the change.
+   * @param minSize
+   * @param maxSize
+   */
+  void setAdaptiveSize(v_buff_size minSize, v_buff_size maxSize);
+
+  /**
+   * Get current buffer size.
+   * @return
+   */
+  v_buff_size getBufferSize() const;
+
+  /**
+   * Point zlib stream output to the active buffer. Takes the next free buffer if there is no active one.
+   * @param zStream
+   * @return - `false` if all buffers are in use.
+   */
+  bool activate(z_stream& zStream);
+
+  /**
+   * Get number of bytes written to the active buffer.
+   * @param zStream
+   * @return
+   */
+  v_buff_size getActiveSize(const z_stream& zStream) const;
+
+  /**
+   * Mark the active buffer as filled.
+   * @param zStream
+   */
+  void commit(z_stream& zStream);
+
+  /**
+   * Drop the active buffer (it has no data).
+   * @param zStream
+   */
+  void close(z_stream& zStream);
+
+  /**
+   * Hand out the oldest filled buffer.
+   * @param dataOut
+   */
+  void handOut(data::buffer::InlineReadData& dataOut);
+
+  /**
+   * Hand out all filled buffers.
+   * @param segments - segments are appended to the vector.
+   */
+  void handOutAll(std::vector<OutputSegment>& segments);
+
+  /**
+   * Client has consumed all buffers handed out - they can be reused.
+   */
+  void release();
+
+  /**
+   * Get number of filled buffers which are not handed out yet.
+   * @return
+   */
+  v_int32 getFilledCount() const;
+
+};
+
 /**
  * Deflate encoder.
  */
-class DeflateEncoder : public oatpp::data::buffer::Processor {
+class DeflateEncoder : public oatpp::data::buffer::Processor, public VectoredProcessor {
 public:
   static constexpr v_int32 ERROR_UNKNOWN = 100;
+public:
+
+  /**
+   * Compression mode chosen by &l:DeflateEncoder::AdaptiveStrategy;.
+   */
+  enum StrategyMode : v_int32 {
+
+    /**
+     * Configured compression level and default strategy.
+     */
+    MODE_NORMAL = 0,
+
+    /**
+     * `Z_HUFFMAN_ONLY` strategy - no match search.
+     */
+    MODE_HUFFMAN_ONLY = 1,
+
+    /**
+     * `Z_NO_COMPRESSION` - data is stored.
+     */
+    MODE_STORED = 2
+
+  };
+
+  /**
+   * Mid-stream level/strategy adaptation. <br>
+   * Compression ratio (compressed/original) is sampled over windows of input. The current deflate block is completed
+   * at the end of each window (`Z_BLOCK`), so the output of the window is measured exactly. When a window barely compresses
+   * the encoder switches to `Z_HUFFMAN_ONLY`, then to `Z_NO_COMPRESSION`,
+   * and switches back when data becomes compressible again.
+   */
+  struct AdaptiveStrategy {
+
+    /**
+     * Input bytes per sampling window.
+     */
+    v_buff_size windowSize = 64 * 1024;
+
+    /**
+     * Window with ratio above this value is considered incompressible.
+     */
+    v_float64 incompressibleRatio = 0.95;
+
+    /**
+     * In &l:DeflateEncoder::MODE_HUFFMAN_ONLY; window with ratio below this value switches back to &l:DeflateEncoder::MODE_NORMAL;.
+     */
+    v_float64 compressibleRatio = 0.8;
+
+    /**
+     * Number of windows in &l:DeflateEncoder::MODE_STORED; before the data is probed again with &l:DeflateEncoder::MODE_HUFFMAN_ONLY;.
+     */
+    v_int32 storedWindows = 8;
+
+  };
+
+private:
+  v_int32 process(data::buffer::InlineReadData& dataIn, bool fillAll);
+  bool fillInput(data::buffer::InlineReadData& dataIn);
+  uLong getTotalOut();
+  void updateContentHash(const void* data, v_buff_size size);
+  v_int32 completeBlock();
+  v_int32 adaptStrategy();
+  v_int32 applyStrategyMode();
 private:
-  std::unique_ptr<v_char8[]> m_buffer;
+  OutputBufferRing m_ring;
   v_buff_size m_bufferSize;
+  v_buff_size m_minBufferSize;
+  v_buff_size m_maxBufferSize;
+private:
+  bool m_adaptive;
+  AdaptiveStrategy m_adaptiveStrategy;
+  v_int32 m_compressionLevel;
+  v_int32 m_mode;
+  v_int32 m_targetMode;
+  v_int32 m_storedWindowsCount;
+  v_int64 m_modeSwitchCount;
+  uLong m_windowIn;
+  uLong m_windowOut;
+private:
+  std::unique_ptr<v_char8[]> m_stage;
+  v_buff_size m_stageCapacity;
+  v_buff_size m_stageSize;
+  bool m_inputStaged;
+  bool m_flushRequested;
+private:
+  Format m_format;
+  HashAlgorithm m_hashAlgorithm;
+  bool m_hashFromStream;
+  uLong m_checksum;
+  XXHash64 m_xxHash;
 private:
   bool m_finished;
   z_stream m_zStream;
@@ -49,8 +268,16 @@ public:
   /**
    * Constructor.
    * @param bufferSize
+   * @param format - &l:Format;.
+   * @param compressionLevel
+   */
+  DeflateEncoder(v_buff_size bufferSize, Format format, v_int32 compressionLevel = Z_DEFAULT_COMPRESSION);
+
+  /**
+   * Constructor.
+   * @param bufferSize
+   * @param gzip - `true` - &l:Format::GZIP;, `false` - &l:Format::ZLIB;.
    * @param compressionLevel
-   * @param useGzip
    */
   DeflateEncoder(v_buff_size bufferSize = 1024, bool gzip = false, v_int32 compressionLevel = Z_DEFAULT_COMPRESSION);
 
@@ -63,6 +290,96 @@ public:
    */
   v_io_size suggestInputStreamReadSize() override;
 
+  /**
+   * Set number of output buffers. Default is `1`. <br>
+   * Buffers are used as a ring - with more than one buffer the encoder keeps compressing into free buffers
+   * while previously returned `dataOut` is still being consumed. To overlap compression with I/O the client
+   * may call `iterate()` with non-empty `dataOut` (ex.: while waiting for the socket to become writable) -
+   * in this case `dataOut` is left untouched and &l:Processor::FLUSH_DATA_OUT; is returned. <br>
+   * Stock transfers never do that - use `oatpp::zlib::transferOverlappedAsync()` (see OverlappedTransfer.hpp). <br>
+   * Call it before the input is processed.
+   * @param count
+   */
+  void setOutputBufferCount(v_int32 count);
+
+  /**
+   * Batch small input chunks before passing them to `deflate()`. <br>
+   * Chunks smaller than `threshold` are copied to the staging buffer until it holds `threshold` bytes,
+   * larger chunks are passed to `deflate()` directly. While coalescing is enabled the suggested read size is `threshold`.
+   * Call it before the input is processed.
+   * @param threshold - staging buffer size. `0` - disable coalescing.
+   */
+  void setInputCoalescing(v_buff_size threshold);
+
+  /**
+   * Adapt output buffer size and suggested read size to the stream within bounds. <br>
+   * Output buffers start at `minSize` and grow when they keep filling up (large responses),
+   * or shrink when they are mostly empty on commit (small responses, frequent flushes).
+   * Suggested read size follows the observed compression ratio so that one read fills about one buffer.
+   * @param minSize - minimal buffer size. Also the initial one.
+   * @param maxSize - maximal buffer size.
+   */
+  void setAdaptiveBufferSize(v_buff_size minSize, v_buff_size maxSize);
+
+  /**
+   * Get the size of output buffers taken next.
+   * @return
+   */
+  v_buff_size getOutputBufferSize() const;
+
+  /**
+   * Request a flush point. All input provided so far (including staged input) is compressed and
+   * emitted up to a byte boundary with `Z_SYNC_FLUSH` before more input is requested.
+   */
+  void flush();
+
+  /**
+   * Enable mid-stream level/strategy adaptation.
+   * @param strategy - &l:DeflateEncoder::AdaptiveStrategy;.
+   */
+  void setAdaptiveStrategy(const AdaptiveStrategy& strategy);
+
+  /**
+   * Get current compression mode.
+   * @return - &l:DeflateEncoder::StrategyMode;.
+   */
+  v_int32 getStrategyMode() const;
+
+  /**
+   * Get number of times the compression mode was switched by &l:DeflateEncoder::AdaptiveStrategy;.
+   * @return
+   */
+  v_int64 getStrategyModeSwitchCount() const;
+
+  /**
+   * Hash the uncompressed content in the same pass as it is compressed. <br>
+   * When the algorithm matches the checksum of the stream (&l:HashAlgorithm::CRC32; for &l:Format::GZIP;,
+   * &l:HashAlgorithm::ADLER32; for &l:Format::ZLIB;) the stream checksum is reused. Call it before the input is processed. <br>
+   * Use &l:HashAlgorithm::XXHASH64; for cache keys and ETags - 32-bit checksums collide too easily.
+   * @param algorithm - &l:HashAlgorithm;.
+   */
+  void setContentHash(HashAlgorithm algorithm);
+
+  /**
+   * Get hash of the uncompressed content. Valid once the stream is finished.
+   * @return
+   */
+  v_uint64 getContentHash() const;
+
+  /**
+   * Get size of the uncompressed content. Valid once the stream is finished.
+   * @return
+   */
+  v_int64 getContentSize() const;
+
+  /**
+   * Get weak ETag of the uncompressed content - `W/"<hash>-<size>"`. Valid once the stream is finished. <br>
+   * The ETag identifies the content, not the encoded representation, so it is weak - a strong ETag
+   * must not be shared by the gzip-encoded and identity representations (RFC 9110, section 8.8.3).
+   * @return - ETag. `nullptr` if no content hash is set (see &l:DeflateEncoder::setContentHash ();).
+   */
+  oatpp::String getETag() const;
+
   /**
    * Process data.
    * @param dataIn - data provided by client to processor. Input data. &id:data::buffer::InlineReadData;.
@@ -72,26 +389,55 @@ public:
    */
   v_int32 iterate(data::buffer::InlineReadData& dataIn, data::buffer::InlineReadData& dataOut) override;
 
+  /**
+   * Process data handing out all filled output buffers at once. <br>
+   * Filled buffers are held until all of them are filled, a flush point is reached (see &l:DeflateEncoder::flush ();)
+   * or the stream is finished - use &l:DeflateEncoder::setOutputBufferCount (); to set the number of buffers.
+   * @param dataIn - data provided by client to processor. Input data. &id:data::buffer::InlineReadData;.
+   * Set `dataIn` buffer pointer to `nullptr` to designate the end of input.
+   * @param segments - output segments in order. Valid until the next call to `iterateVectored()`.
+   * @return - &l:Processor::Error;.
+   */
+  v_int32 iterateVectored(data::buffer::InlineReadData& dataIn, std::vector<OutputSegment>& segments) override;
+
 };
 
 /**
  * Deflate decoder.
  */
-class DeflateDecoder : public oatpp::data::buffer::Processor {
+class DeflateDecoder : public oatpp::data::buffer::Processor, public VectoredProcessor {
 public:
   static constexpr v_int32 ERROR_UNKNOWN = 100;
 private:
-  std::unique_ptr<v_char8[]> m_buffer;
+  v_int32 process(data::buffer::InlineReadData& dataIn, bool fillAll);
+private:
+  OutputBufferRing m_ring;
   v_buff_size m_bufferSize;
+  v_buff_size m_minBufferSize;
+  v_buff_size m_maxBufferSize;
 private:
+  bool m_multiMember;
+  bool m_memberEnded;
   bool m_finished;
   z_stream m_zStream;
+private:
+  /* totals of the gzip members before the current one - inflateReset() zeroes total_in/total_out */
+  uLong m_membersIn;
+  uLong m_membersOut;
 public:
 
+  /**
+   * Constructor. <br>
+   * &l:Format::GZIP; input may consist of several concatenated gzip members - they are decoded as one stream.
+   * @param bufferSize
+   * @param format - &l:Format;.
+   */
+  DeflateDecoder(v_buff_size bufferSize, Format format);
+
   /**
    * Constructor.
    * @param bufferSize
-   * @param gzip
+   * @param gzip - `true` - &l:Format::GZIP;, `false` - &l:Format::ZLIB;.
    */
   DeflateDecoder(v_buff_size bufferSize = 1024, bool gzip = false);
 
@@ -104,6 +450,76 @@ public:
    */
   v_io_size suggestInputStreamReadSize() override;
 
+  /**
+   * Set number of output buffers. Default is `1`. <br>
+   * Works the same way as &l:DeflateEncoder::setOutputBufferCount ();. Call it before the input is processed.
+   * @param count
+   */
+  void setOutputBufferCount(v_int32 count);
+
+  /**
+   * Adapt output buffer size and suggested read size to the stream within bounds. <br>
+   * Works the same way as &l:DeflateEncoder::setAdaptiveBufferSize ();.
+   * @param minSize - minimal buffer size. Also the initial one.
+   * @param maxSize - maximal buffer size.
+   */
+  void setAdaptiveBufferSize(v_buff_size minSize, v_buff_size maxSize);
+
+  /**
+   * Get the size of output buffers taken next.
+   * @return
+   */
+  v_buff_size getOutputBufferSize() const;
+
+  /**
+   * Process data.
+   * @param dataIn - data provided by client to processor. Input data. &id:data::buffer::InlineReadData;.
+   * Set `dataIn` buffer pointer to `nullptr` to designate the end of input.
+   * @param dataOut - data provided to client by processor. Output data. &id:data::buffer::InlineReadData;.
+   * @return - &l:Processor::Error;.
+   */
+  v_int32 iterate(data::buffer::InlineReadData& dataIn, data::buffer::InlineReadData& dataOut) override;
+
+  /**
+   * Process data handing out all filled output buffers at once. <br>
+   * Filled buffers are held until all of them are filled or the stream is finished -
+   * use &l:DeflateDecoder::setOutputBufferCount (); to set the number of buffers.
+   * @param dataIn - data provided by client to processor. Input data. &id:data::buffer::InlineReadData;.
+   * Set `dataIn` buffer pointer to `nullptr` to designate the end of input.
+   * @param segments - output segments in order. Valid until the next call to `iterateVectored()`.
+   * @return - &l:Processor::Error;.
+   */
+  v_int32 iterateVectored(data::buffer::InlineReadData& dataIn, std::vector<OutputSegment>& segments) override;
+
+};
+
+/**
+ * Pass-through processor.
+ * Forwards input to output untouched - no compression or decompression is done, input is not copied.
+ * `dataOut` points to the `dataIn` buffer, `dataIn` is consumed once `dataOut` is consumed.
+ * Use it to relay content which is already encoded (ex.: by an upstream server).
+ */
+class PassThroughProcessor : public oatpp::data::buffer::Processor {
+private:
+  v_buff_size m_bufferSize;
+  v_buff_size m_outSize;
+private:
+  bool m_finished;
+public:
+
+  /**
+   * Constructor.
+   * @param bufferSize - suggested read size.
+   */
+  PassThroughProcessor(v_buff_size bufferSize = 1024);
+
+  /**
+   * If the client is using the input stream to read data and push it to the processor,
+   * the client MAY ask the processor for a suggested read size.
+   * @return - suggested read size.
+   */
+  v_io_size suggestInputStreamReadSize() override;
+
   /**
    * Process data.
    * @param dataIn - data provided by client to processor. Input data. &id:data::buffer::InlineReadData;.
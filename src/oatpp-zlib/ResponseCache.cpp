@@ -0,0 +1,413 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#include "ResponseCache.hpp"
+
+#include "oatpp/data/buffer/IOBuffer.hpp"
+
+#include <cstdio>
+#include <iterator>
+
+namespace oatpp { namespace zlib {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// ResponseCache
+
+ResponseCache::ResponseCache(v_int64 maxSize, v_int32 shardsCount)
+  : m_maxSize(maxSize)
+  , m_hits(0)
+  , m_misses(0)
+  , m_insertions(0)
+  , m_evictions(0)
+{
+
+  if(shardsCount < 1) {
+    throw std::runtime_error("[oatpp::zlib::ResponseCache::ResponseCache()]: Error. Invalid shards count.");
+  }
+
+  m_shardCapacity = maxSize / shardsCount;
+  for(v_int32 i = 0; i < shardsCount; i ++) {
+    m_shards.push_back(std::unique_ptr<Shard>(new Shard()));
+  }
+
+}
+
+std::string ResponseCache::makeKey(const oatpp::String& key, const oatpp::String& encoding) {
+  std::string result;
+  result.reserve(encoding->size() + 1 + key->size());
+  result.append(encoding->data(), encoding->size());
+  result.push_back(' ');
+  result.append(key->data(), key->size());
+  return result;
+}
+
+ResponseCache::Shard& ResponseCache::getShard(const std::string& key) {
+  return *m_shards[std::hash<std::string>{}(key) % m_shards.size()];
+}
+
+oatpp::String ResponseCache::get(const oatpp::String& key, const oatpp::String& encoding, const oatpp::String& content) {
+
+  auto fullKey = makeKey(key, encoding);
+  auto& shard = getShard(fullKey);
+
+  {
+    std::lock_guard<std::mutex> guard(shard.lock);
+    auto it = shard.index.find(fullKey);
+    if(it != shard.index.end()) {
+      const auto& stored = it->second->content;
+      /* same key, different content - key collision */
+      if(!stored || (content && *stored == *content)) {
+        shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+        m_hits.fetch_add(1, std::memory_order_relaxed);
+        return it->second->data;
+      }
+    }
+  }
+
+  m_misses.fetch_add(1, std::memory_order_relaxed);
+  return nullptr;
+
+}
+
+bool ResponseCache::put(const oatpp::String& key, const oatpp::String& encoding, const oatpp::String& data, const oatpp::String& content) {
+
+  if(!data) {
+    return false;
+  }
+
+  auto fullKey = makeKey(key, encoding);
+  v_int64 entrySize = getEntrySize(key, encoding, (v_buff_size) data->size(), content ? (v_buff_size) content->size() : 0);
+
+  if(entrySize > m_shardCapacity) {
+    return false;
+  }
+
+  auto& shard = getShard(fullKey);
+  std::lock_guard<std::mutex> guard(shard.lock);
+
+  auto it = shard.index.find(fullKey);
+  if(it != shard.index.end()) {
+    shard.size -= it->second->size;
+    shard.entries.erase(it->second);
+    shard.index.erase(it);
+  }
+
+  shard.entries.push_front({fullKey, data, content, entrySize});
+  shard.index[fullKey] = shard.entries.begin();
+  shard.size += entrySize;
+  m_insertions.fetch_add(1, std::memory_order_relaxed);
+
+  while(shard.size > m_shardCapacity) {
+    auto& last = shard.entries.back();
+    shard.size -= last.size;
+    shard.index.erase(last.key);
+    shard.entries.pop_back();
+    m_evictions.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  return true;
+
+}
+
+bool ResponseCache::admit(const oatpp::String& key, const oatpp::String& encoding) {
+
+  auto fullKey = makeKey(key, encoding);
+  auto& shard = getShard(fullKey);
+  std::lock_guard<std::mutex> guard(shard.lock);
+
+  auto it = shard.candidatesIndex.find(fullKey);
+  if(it != shard.candidatesIndex.end()) {
+    shard.candidates.erase(it->second);
+    shard.candidatesIndex.erase(it);
+    return true;
+  }
+
+  shard.candidates.push_back(fullKey);
+  shard.candidatesIndex[fullKey] = std::prev(shard.candidates.end());
+
+  if((v_int64) shard.candidates.size() > CANDIDATES_PER_SHARD) {
+    shard.candidatesIndex.erase(shard.candidates.front());
+    shard.candidates.pop_front();
+  }
+
+  return false;
+
+}
+
+bool ResponseCache::remove(const oatpp::String& key, const oatpp::String& encoding) {
+
+  auto fullKey = makeKey(key, encoding);
+  auto& shard = getShard(fullKey);
+  std::lock_guard<std::mutex> guard(shard.lock);
+
+  auto it = shard.index.find(fullKey);
+  if(it == shard.index.end()) {
+    return false;
+  }
+
+  shard.size -= it->second->size;
+  shard.entries.erase(it->second);
+  shard.index.erase(it);
+  return true;
+
+}
+
+oatpp::String ResponseCache::getOrCompress(const oatpp::String& key,
+                                           const std::shared_ptr<web::protocol::http::encoding::EncoderProvider>& provider,
+                                           const std::function<oatpp::String()>& bodyGenerator)
+{
+
+  auto encoding = provider->getEncodingName();
+
+  auto result = get(key, encoding);
+  if(result) {
+    return result;
+  }
+
+  auto body = bodyGenerator();
+  if(!body) {
+    return nullptr;
+  }
+
+  result = compress(provider, body);
+  put(key, encoding, result);
+  return result;
+
+}
+
+void ResponseCache::clear() {
+  for(auto& shard : m_shards) {
+    std::lock_guard<std::mutex> guard(shard->lock);
+    shard->entries.clear();
+    shard->index.clear();
+    shard->candidates.clear();
+    shard->candidatesIndex.clear();
+    shard->size = 0;
+  }
+}
+
+ResponseCache::Stats ResponseCache::getStats() {
+
+  Stats stats;
+  stats.hits = m_hits.load(std::memory_order_relaxed);
+  stats.misses = m_misses.load(std::memory_order_relaxed);
+  stats.insertions = m_insertions.load(std::memory_order_relaxed);
+  stats.evictions = m_evictions.load(std::memory_order_relaxed);
+  stats.entriesCount = 0;
+  stats.size = 0;
+
+  for(auto& shard : m_shards) {
+    std::lock_guard<std::mutex> guard(shard->lock);
+    stats.entriesCount += (v_int64) shard->entries.size();
+    stats.size += shard->size;
+  }
+
+  return stats;
+
+}
+
+v_int64 ResponseCache::getMaxSize() const {
+  return m_maxSize;
+}
+
+v_int64 ResponseCache::getMaxEntrySize() const {
+  return m_shardCapacity;
+}
+
+v_int64 ResponseCache::getEntrySize(const oatpp::String& key, const oatpp::String& encoding, v_buff_size dataSize, v_buff_size contentSize) {
+  /* key in the index is "<encoding> <key>" - see makeKey() */
+  return (v_int64) (encoding->size() + 1 + key->size()) + dataSize + contentSize + ENTRY_OVERHEAD;
+}
+
+oatpp::String ResponseCache::getContentKey(const void* data, v_buff_size size) {
+  return getContentKey(XXHash64::hash(data, size), size);
+}
+
+oatpp::String ResponseCache::getContentKey(v_uint64 hash, v_buff_size size) {
+  char key[48];
+  std::snprintf(key, sizeof(key), "%016llx-%lld", (unsigned long long) hash, (long long) size);
+  return oatpp::String(key);
+}
+
+oatpp::String ResponseCache::compress(const std::shared_ptr<web::protocol::http::encoding::EncoderProvider>& provider,
+                                      const oatpp::String& data)
+{
+
+  data::stream::BufferInputStream inStream(data);
+  data::stream::BufferOutputStream outStream;
+  data::buffer::IOBuffer buffer;
+
+  auto res = data::stream::transfer(&inStream, &outStream, 0, buffer.getData(), buffer.getSize(), provider->getProcessor());
+  if(res < 0) {
+    return nullptr;
+  }
+
+  return outStream.toString();
+
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// CachingProcessor
+
+CachingProcessor::CachingProcessor(const std::shared_ptr<web::protocol::http::encoding::EncoderProvider>& provider,
+                                   const std::shared_ptr<ResponseCache>& cache,
+                                   v_buff_size maxBodySize)
+  : m_provider(provider)
+  , m_cache(cache)
+  , m_maxBodySize(maxBodySize)
+  , m_state(STATE_COLLECT)
+{
+  /* the entry holds the key, the body and the compressed data - a larger body can't be cached, don't hold it back */
+  auto longestKey = ResponseCache::getContentKey((v_uint64) 0, m_maxBodySize);
+  v_int64 available = cache->getMaxEntrySize() - ResponseCache::getEntrySize(longestKey, provider->getEncodingName(), 0, 0);
+  /* incompressible data grows by up to ~0.03% plus block and wrapper bytes - see deflateBound() */
+  available -= 64;
+  v_int64 fitSize = available * 4096 / (2 * 4096 + 2);
+  if(m_maxBodySize > fitSize) {
+    m_maxBodySize = fitSize > 0 ? (v_buff_size) fitSize : 0;
+  }
+}
+
+v_io_size CachingProcessor::suggestInputStreamReadSize() {
+  if(m_processor) {
+    return m_processor->suggestInputStreamReadSize();
+  }
+  return 16 * 1024;
+}
+
+v_int32 CachingProcessor::iterateStream(data::buffer::InlineReadData& dataIn, data::buffer::InlineReadData& dataOut) {
+
+  if(m_backlog) {
+    auto res = m_processor->iterate(m_backlogIn, dataOut);
+    if(res != Error::PROVIDE_DATA_IN) {
+      return res;
+    }
+    m_backlog = nullptr;
+  }
+
+  return m_processor->iterate(dataIn, dataOut);
+
+}
+
+v_int32 CachingProcessor::iterate(data::buffer::InlineReadData& dataIn, data::buffer::InlineReadData& dataOut) {
+
+  if(dataOut.bytesLeft > 0) {
+    return Error::FLUSH_DATA_OUT;
+  }
+
+  switch(m_state) {
+
+    case STATE_COLLECT: {
+
+      if(dataIn.currBufferPtr != nullptr) {
+
+        if(dataIn.bytesLeft == 0) {
+          return Error::PROVIDE_DATA_IN;
+        }
+
+        if(m_body.getCurrentPosition() + dataIn.bytesLeft > m_maxBodySize) {
+          /* too large to cache - stream the collected part and the rest through the provider's processor */
+          m_backlog = m_body.toString();
+          m_backlogIn.set(m_backlog->data(), m_backlog->size());
+          m_body.setCurrentPosition(0);
+          m_processor = m_provider->getProcessor();
+          m_state = STATE_STREAM;
+          return iterateStream(dataIn, dataOut);
+        }
+
+        m_hash.update(dataIn.currBufferPtr, dataIn.bytesLeft);
+        m_body.writeSimple(dataIn.currBufferPtr, dataIn.bytesLeft);
+        dataIn.inc(dataIn.bytesLeft);
+        return Error::PROVIDE_DATA_IN;
+
+      }
+
+      auto key = ResponseCache::getContentKey(m_hash.digest(), m_body.getCurrentPosition());
+      auto encoding = m_provider->getEncodingName();
+      auto body = m_body.toString();
+
+      m_result = m_cache->get(key, encoding, body);
+      if(!m_result) {
+        m_result = ResponseCache::compress(m_provider, body);
+        if(!m_result) {
+          m_state = STATE_DONE;
+          dataOut.set(nullptr, 0);
+          return ERROR_UNKNOWN;
+        }
+        if(m_cache->admit(key, encoding)) {
+          m_cache->put(key, encoding, m_result, body);
+        }
+      }
+
+      m_body.setCurrentPosition(0);
+      m_state = STATE_SERVE;
+
+      if(m_result->size() > 0) {
+        dataOut.set(m_result->data(), m_result->size());
+        return Error::FLUSH_DATA_OUT;
+      }
+
+      m_state = STATE_DONE;
+      break;
+
+    }
+
+    case STATE_SERVE:
+      m_result = nullptr;
+      m_state = STATE_DONE;
+      break;
+
+    case STATE_STREAM:
+      return iterateStream(dataIn, dataOut);
+
+    default:
+      break;
+
+  }
+
+  dataOut.set(nullptr, 0);
+  return Error::FINISHED;
+
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// CachingEncoderProvider
+
+CachingEncoderProvider::CachingEncoderProvider(const std::shared_ptr<web::protocol::http::encoding::EncoderProvider>& provider,
+                                               const std::shared_ptr<ResponseCache>& cache,
+                                               v_buff_size maxBodySize)
+  : m_provider(provider)
+  , m_cache(cache)
+  , m_maxBodySize(maxBodySize)
+{}
+
+oatpp::String CachingEncoderProvider::getEncodingName() {
+  return m_provider->getEncodingName();
+}
+
+std::shared_ptr<data::buffer::Processor> CachingEncoderProvider::getProcessor() {
+  return std::make_shared<CachingProcessor>(m_provider, m_cache, m_maxBodySize);
+}
+
+}}
@@ -0,0 +1,356 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#ifndef oatpp_zlib_ResponseCache_hpp
+#define oatpp_zlib_ResponseCache_hpp
+
+#include "Hash.hpp"
+
+#include "oatpp/web/protocol/http/encoding/EncoderProvider.hpp"
+#include "oatpp/data/stream/BufferStream.hpp"
+
+#include <atomic>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace oatpp { namespace zlib {
+
+/**
+ * In-memory cache of compressed responses. <br>
+ * Entries are keyed by an application-provided key (or a content key - see &l:ResponseCache::getContentKey ();)
+ * plus encoding name. The cache is bounded by the total size of entries and evicts least recently used entries first.
+ * Keys are distributed over shards, each shard has its own lock. <br>
+ * Content keys are not collision resistant - entries put by content key should keep the uncompressed content
+ * (`content` parameter of &l:ResponseCache::put ();) so it is compared on every hit.
+ */
+class ResponseCache {
+public:
+
+  /**
+   * Approximate per-entry memory overhead counted towards the cache size.
+   */
+  static constexpr v_int64 ENTRY_OVERHEAD = 128;
+
+  /**
+   * Maximum number of keys per shard remembered by &l:ResponseCache::admit ();.
+   */
+  static constexpr v_int64 CANDIDATES_PER_SHARD = 1024;
+
+public:
+
+  /**
+   * Cache statistics.
+   */
+  struct Stats {
+
+    /**
+     * Number of lookups served from the cache.
+     */
+    v_int64 hits;
+
+    /**
+     * Number of lookups which didn't find an entry.
+     */
+    v_int64 misses;
+
+    /**
+     * Number of entries put to the cache.
+     */
+    v_int64 insertions;
+
+    /**
+     * Number of entries evicted to stay within the size limit.
+     */
+    v_int64 evictions;
+
+    /**
+     * Current number of entries.
+     */
+    v_int64 entriesCount;
+
+    /**
+     * Current size of the cache in bytes (including &l:ResponseCache::ENTRY_OVERHEAD;).
+     */
+    v_int64 size;
+
+  };
+
+private:
+
+  struct Entry {
+    std::string key;
+    oatpp::String data;
+    oatpp::String content;
+    v_int64 size;
+  };
+
+  struct Shard {
+    std::mutex lock;
+    std::list<Entry> entries; // most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    std::list<std::string> candidates; // oldest first
+    std::unordered_map<std::string, std::list<std::string>::iterator> candidatesIndex;
+    v_int64 size = 0;
+  };
+
+private:
+  static std::string makeKey(const oatpp::String& key, const oatpp::String& encoding);
+  Shard& getShard(const std::string& key);
+private:
+  v_int64 m_maxSize;
+  v_int64 m_shardCapacity;
+  std::vector<std::unique_ptr<Shard>> m_shards;
+  std::atomic<v_int64> m_hits;
+  std::atomic<v_int64> m_misses;
+  std::atomic<v_int64> m_insertions;
+  std::atomic<v_int64> m_evictions;
+public:
+
+  /**
+   * Constructor.
+   * @param maxSize - maximum total size of entries in bytes. Each shard gets an equal part of it.
+   * @param shardsCount - number of shards.
+   */
+  ResponseCache(v_int64 maxSize, v_int32 shardsCount = 16);
+
+  /**
+   * Get cached compressed data.
+   * @param key - application-provided key or content key.
+   * @param encoding - encoding name. Ex.: "gzip".
+   * @param content - uncompressed content. If the entry was put with content, a hit requires the same content.
+   * @return - compressed data or `nullptr` if there is no entry.
+   */
+  oatpp::String get(const oatpp::String& key, const oatpp::String& encoding, const oatpp::String& content = nullptr);
+
+  /**
+   * Put compressed data to the cache. Replaces existing entry. <br>
+   * Entries larger than &l:ResponseCache::getMaxEntrySize (); are not cached.
+   * @param key - application-provided key or content key.
+   * @param encoding - encoding name. Ex.: "gzip".
+   * @param data - compressed data.
+   * @param content - uncompressed content to compare on hit. Counts towards the entry size.
+   * Pass it with content keys.
+   * @return - `true` if the entry was cached.
+   */
+  bool put(const oatpp::String& key, const oatpp::String& encoding, const oatpp::String& data, const oatpp::String& content = nullptr);
+
+  /**
+   * Admission filter against one-off responses. <br>
+   * Returns `true` if the key was offered before and is still among the last
+   * &l:ResponseCache::CANDIDATES_PER_SHARD; keys offered to its shard. Otherwise remembers the key and returns `false`.
+   * @param key - application-provided key or content key.
+   * @param encoding - encoding name.
+   * @return - `true` if the entry is worth caching.
+   */
+  bool admit(const oatpp::String& key, const oatpp::String& encoding);
+
+  /**
+   * Remove entry.
+   * @param key - application-provided key or content key.
+   * @param encoding - encoding name.
+   * @return - `true` if the entry was removed.
+   */
+  bool remove(const oatpp::String& key, const oatpp::String& encoding);
+
+  /**
+   * Get cached compressed data. On miss, compress the body with the provider and cache the result. <br>
+   * Concurrent misses on the same key may compress the body more than once.
+   * @param key - application-provided key or content key.
+   * @param provider - &id:oatpp::web::protocol::http::encoding::EncoderProvider;.
+   * @param bodyGenerator - called on miss only.
+   * @return - compressed data.
+   */
+  oatpp::String getOrCompress(const oatpp::String& key,
+                              const std::shared_ptr<web::protocol::http::encoding::EncoderProvider>& provider,
+                              const std::function<oatpp::String()>& bodyGenerator);
+
+  /**
+   * Remove all entries. Statistics are kept.
+   */
+  void clear();
+
+  /**
+   * Get cache statistics.
+   * @return - &l:ResponseCache::Stats;.
+   */
+  Stats getStats();
+
+  /**
+   * Get maximum total size of entries.
+   * @return
+   */
+  v_int64 getMaxSize() const;
+
+  /**
+   * Get maximum size of an entry (including the content and &l:ResponseCache::ENTRY_OVERHEAD;) -
+   * maximum total size divided by the number of shards.
+   * @return
+   */
+  v_int64 getMaxEntrySize() const;
+
+  /**
+   * Get size counted towards the cache size for an entry.
+   * @param key - application-provided key or content key.
+   * @param encoding - encoding name.
+   * @param dataSize - size of the compressed data.
+   * @param contentSize - size of the uncompressed content kept in the entry. `0` if there is no content.
+   * @return
+   */
+  static v_int64 getEntrySize(const oatpp::String& key, const oatpp::String& encoding, v_buff_size dataSize, v_buff_size contentSize);
+
+  /**
+   * Make key from the content - xxHash64 of the data plus the data size. <br>
+   * The key is not collision resistant - put entries with the content to compare it on hit.
+   * @param data
+   * @param size
+   * @return
+   */
+  static oatpp::String getContentKey(const void* data, v_buff_size size);
+
+  /**
+   * Make content key from xxHash64 (seed `0`) computed by the caller.
+   * @param hash - xxHash64 of the data. See &id:oatpp::zlib::XXHash64;.
+   * @param size - data size.
+   * @return
+   */
+  static oatpp::String getContentKey(v_uint64 hash, v_buff_size size);
+
+  /**
+   * Compress data with the provider's processor.
+   * @param provider - &id:oatpp::web::protocol::http::encoding::EncoderProvider;.
+   * @param data
+   * @return - compressed data or `nullptr` in case of error.
+   */
+  static oatpp::String compress(const std::shared_ptr<web::protocol::http::encoding::EncoderProvider>& provider,
+                                const oatpp::String& data);
+
+};
+
+/**
+ * Processor created by &l:CachingEncoderProvider;. <br>
+ * Collects the body and looks it up in the cache by content key at the end of input.
+ * A hit is served from the cache, a miss is compressed and cached once the same body is seen the second time
+ * (see &l:ResponseCache::admit ();). <br>
+ * Nothing is sent until the whole body is collected. Once the body exceeds `maxBodySize` or can't fit
+ * into the cache (see &l:ResponseCache::getMaxEntrySize ();) it is streamed through the provider's processor without caching.
+ */
+class CachingProcessor : public oatpp::data::buffer::Processor {
+public:
+  static constexpr v_int32 ERROR_UNKNOWN = 100;
+private:
+
+  enum State : v_int32 {
+    STATE_COLLECT = 0,
+    STATE_SERVE = 1,
+    STATE_STREAM = 2,
+    STATE_DONE = 3
+  };
+
+private:
+  v_int32 iterateStream(data::buffer::InlineReadData& dataIn, data::buffer::InlineReadData& dataOut);
+private:
+  std::shared_ptr<web::protocol::http::encoding::EncoderProvider> m_provider;
+  std::shared_ptr<ResponseCache> m_cache;
+  v_buff_size m_maxBodySize;
+  v_int32 m_state;
+  data::stream::BufferOutputStream m_body;
+  XXHash64 m_hash;
+  oatpp::String m_backlog;
+  data::buffer::InlineReadData m_backlogIn;
+  oatpp::String m_result;
+  std::shared_ptr<data::buffer::Processor> m_processor;
+public:
+
+  /**
+   * Constructor.
+   * @param provider - &id:oatpp::web::protocol::http::encoding::EncoderProvider;.
+   * @param cache - &l:ResponseCache;.
+   * @param maxBodySize - maximum size of the body to cache. Limited by the size of the cache entry.
+   */
+  CachingProcessor(const std::shared_ptr<web::protocol::http::encoding::EncoderProvider>& provider,
+                   const std::shared_ptr<ResponseCache>& cache,
+                   v_buff_size maxBodySize);
+
+  /**
+   * If the client is using the input stream to read data and push it to the processor,
+   * the client MAY ask the processor for a suggested read size.
+   * @return - suggested read size.
+   */
+  v_io_size suggestInputStreamReadSize() override;
+
+  /**
+   * Process data.
+   * @param dataIn - data provided by client to processor. Input data. &id:data::buffer::InlineReadData;.
+   * Set `dataIn` buffer pointer to `nullptr` to designate the end of input.
+   * @param dataOut - data provided to client by processor. Output data. &id:data::buffer::InlineReadData;.
+   * @return - &l:Processor::Error;.
+   */
+  v_int32 iterate(data::buffer::InlineReadData& dataIn, data::buffer::InlineReadData& dataOut) override;
+
+};
+
+/**
+ * EncoderProvider which serves repeated responses from &l:ResponseCache;. <br>
+ * Wraps another provider (ex.: &id:oatpp::zlib::GzipEncoderProvider;) - same encoding name,
+ * the wrapped provider compresses cache misses. <br>
+ * Bodies up to `maxBodySize` are buffered before the first byte is sent -
+ * use it for endpoints with small repeated responses, not for streaming or large unique responses.
+ */
+class CachingEncoderProvider : public web::protocol::http::encoding::EncoderProvider {
+private:
+  std::shared_ptr<web::protocol::http::encoding::EncoderProvider> m_provider;
+  std::shared_ptr<ResponseCache> m_cache;
+  v_buff_size m_maxBodySize;
+public:
+
+  /**
+   * Constructor.
+   * @param provider - provider to compress cache misses with.
+   * @param cache - &l:ResponseCache;.
+   * @param maxBodySize - larger bodies are not cached and are streamed from the moment they exceed it.
+   */
+  CachingEncoderProvider(const std::shared_ptr<web::protocol::http::encoding::EncoderProvider>& provider,
+                         const std::shared_ptr<ResponseCache>& cache,
+                         v_buff_size maxBodySize = 64 * 1024);
+
+  /**
+   * Get encoding name.
+   * @return
+   */
+  oatpp::String getEncodingName() override;
+
+  /**
+   * Get &id:oatpp::data::buffer::Processor; for chunked encoding.
+   * @return - &l:CachingProcessor;
+   */
+  std::shared_ptr<data::buffer::Processor> getProcessor() override;
+
+};
+
+}}
+
+#endif // oatpp_zlib_ResponseCache_hpp
@@ -0,0 +1,332 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#include "Transcoder.hpp"
+#include "oatpp/base/Log.hpp"
+
+#include <cstring>
+
+namespace oatpp { namespace zlib {
+
+Transcoder::Transcoder(v_buff_size bufferSize, bool gzip)
+  : m_buffer(new v_char8[bufferSize])
+  , m_bufferSize(bufferSize)
+  , m_bufferPos(0)
+  , m_scratch(new v_char8[bufferSize])
+  , m_framePos(0)
+  , m_frameSize(0)
+  , m_gzip(gzip)
+  , m_inGzip(false)
+  , m_trailerSize(0)
+  , m_trailerPos(0)
+  , m_check(0)
+  , m_inCheck(0)
+  , m_state(STATE_HEADER)
+  , m_finished(false)
+{
+
+  m_zStream.zalloc = Z_NULL;
+  m_zStream.zfree = Z_NULL;
+  m_zStream.opaque = Z_NULL;
+
+  m_zStream.next_in = nullptr;
+  m_zStream.avail_in = 0;
+  m_zStream.next_out = nullptr;
+  m_zStream.avail_out = 0;
+
+  /* 15 + 32 - detect gzip or zlib header automatically */
+  v_int32 res = inflateInit2(&m_zStream, 15 + 32);
+  if(res != Z_OK) {
+    OATPP_LOGe("[oatpp::zlib::Transcoder::Transcoder()]", "Error. Failed call to 'inflateInit2()'. Result {}", res)
+    throw std::runtime_error("[oatpp::zlib::Transcoder::Transcoder()]: Error. Can't init.");
+  }
+
+  m_zStream.data_type = 0;
+
+}
+
+Transcoder::~Transcoder() {
+  v_int32 res = inflateEnd(&m_zStream);
+  if(res != Z_OK) {
+    OATPP_LOGe("[oatpp::zlib::Transcoder::~Transcoder()]", "Error. Failed call to 'inflateEnd()'. Result {}", res)
+  }
+}
+
+void Transcoder::writeFrame() {
+  v_buff_size size = m_frameSize - m_framePos;
+  if(size > m_bufferSize - m_bufferPos) {
+    size = m_bufferSize - m_bufferPos;
+  }
+  std::memcpy(m_buffer.get() + m_bufferPos, m_frame + m_framePos, size);
+  m_bufferPos += size;
+  m_framePos += size;
+}
+
+v_int32 Transcoder::processHeader(data::buffer::InlineReadData& dataIn) {
+
+  if(m_zStream.total_in == 0) {
+    m_inGzip = ((p_char8) dataIn.currBufferPtr)[0] == 0x1f;
+    if(m_inGzip == m_gzip) {
+      m_state = STATE_PASS;
+      return Z_OK;
+    }
+    if(m_gzip) {
+      const v_char8 header[10] = {0x1f, 0x8b, Z_DEFLATED, 0, 0, 0, 0, 0, 0, 0xff};
+      std::memcpy(m_frame, header, 10);
+      m_frameSize = 10;
+      m_check = crc32(0L, Z_NULL, 0);
+    } else {
+      /* CMF - deflate with 32K window, FLG - default compression level */
+      m_frame[0] = 0x78;
+      m_frame[1] = 0x9c;
+      m_frameSize = 2;
+      m_check = adler32(0L, Z_NULL, 0);
+    }
+    m_inCheck = m_inGzip ? crc32(0L, Z_NULL, 0) : adler32(0L, Z_NULL, 0);
+  }
+
+  m_zStream.next_in = (Bytef *) dataIn.currBufferPtr;
+  m_zStream.avail_in = (uInt) dataIn.bytesLeft;
+
+  /* Z_BLOCK - stop right after the header, before the first deflate block */
+  int res = Z_OK;
+  while(res == Z_OK && m_zStream.avail_in > 0 && (m_zStream.data_type & 128) == 0) {
+    m_zStream.next_out = (Bytef *) m_scratch.get();
+    m_zStream.avail_out = (uInt) m_bufferSize;
+    res = inflate(&m_zStream, Z_BLOCK);
+  }
+
+  /* header bytes are dropped */
+  dataIn.inc(dataIn.bytesLeft - m_zStream.avail_in);
+
+  if(res != Z_OK && res != Z_BUF_ERROR) {
+    return res;
+  }
+
+  if(m_zStream.data_type & 128) {
+    res = inflateReset2(&m_zStream, -15);
+    if(res != Z_OK) {
+      return res;
+    }
+    m_state = STATE_PAYLOAD;
+  }
+
+  return Z_OK;
+
+}
+
+v_int32 Transcoder::processPayload(data::buffer::InlineReadData& dataIn) {
+
+  /* consumed payload is forwarded as-is, so consume no more than fits the buffer */
+  v_buff_size size = dataIn.bytesLeft;
+  if(size > m_bufferSize - m_bufferPos) {
+    size = m_bufferSize - m_bufferPos;
+  }
+
+  m_zStream.next_in = (Bytef *) dataIn.currBufferPtr;
+  m_zStream.avail_in = (uInt) size;
+
+  int res = Z_OK;
+  do {
+
+    m_zStream.next_out = (Bytef *) m_scratch.get();
+    m_zStream.avail_out = (uInt) m_bufferSize;
+    res = inflate(&m_zStream, Z_NO_FLUSH);
+
+    /* output checksum is computed for the output trailer, input checksum - to verify the input trailer */
+    uInt decoded = (uInt) m_bufferSize - m_zStream.avail_out;
+    if(m_gzip) {
+      m_check = crc32(m_check, m_scratch.get(), decoded);
+      m_inCheck = adler32(m_inCheck, m_scratch.get(), decoded);
+    } else {
+      m_check = adler32(m_check, m_scratch.get(), decoded);
+      m_inCheck = crc32(m_inCheck, m_scratch.get(), decoded);
+    }
+
+  } while(res == Z_OK && (m_zStream.avail_in > 0 || m_zStream.avail_out == 0));
+
+  v_buff_size consumed = size - m_zStream.avail_in;
+  std::memcpy(m_buffer.get() + m_bufferPos, dataIn.currBufferPtr, consumed);
+  m_bufferPos += consumed;
+  dataIn.inc(consumed);
+
+  if(res == Z_STREAM_END) {
+    m_trailerSize = m_inGzip ? 8 : 4;
+    m_trailerPos = 0;
+    m_state = STATE_TRAILER;
+    return Z_OK;
+  }
+
+  if(res == Z_BUF_ERROR) {
+    return Z_OK;
+  }
+
+  return res;
+
+}
+
+v_int32 Transcoder::processTrailer(data::buffer::InlineReadData& dataIn) {
+
+  v_buff_size size = dataIn.bytesLeft;
+  if(size > m_trailerSize - m_trailerPos) {
+    size = m_trailerSize - m_trailerPos;
+  }
+  std::memcpy(m_trailer + m_trailerPos, dataIn.currBufferPtr, size);
+  m_trailerPos += size;
+  dataIn.inc(size);
+
+  if(m_trailerPos < m_trailerSize) {
+    return Z_OK;
+  }
+
+  /* verify input trailer - gzip: CRC-32 and ISIZE little-endian, zlib: Adler-32 big-endian */
+  uLong inCheck = 0;
+  if(m_inGzip) {
+    uLong inLength = 0;
+    for(v_int32 i = 0; i < 4; i ++) {
+      inCheck |= (uLong) m_trailer[i] << (i * 8);
+      inLength |= (uLong) m_trailer[i + 4] << (i * 8);
+    }
+    if(inLength != (m_zStream.total_out & 0xFFFFFFFF)) {
+      return Z_DATA_ERROR;
+    }
+  } else {
+    for(v_int32 i = 0; i < 4; i ++) {
+      inCheck = (inCheck << 8) | m_trailer[i];
+    }
+  }
+
+  if(inCheck != m_inCheck) {
+    return Z_DATA_ERROR;
+  }
+
+  uLong check = m_check;
+  if(m_gzip) {
+    uLong length = m_zStream.total_out;
+    for(v_int32 i = 0; i < 4; i ++) {
+      m_frame[i] = (v_char8) (check >> (i * 8));
+      m_frame[i + 4] = (v_char8) (length >> (i * 8));
+    }
+    m_frameSize = 8;
+  } else {
+    for(v_int32 i = 0; i < 4; i ++) {
+      m_frame[i] = (v_char8) (check >> ((3 - i) * 8));
+    }
+    m_frameSize = 4;
+  }
+  m_framePos = 0;
+
+  m_state = STATE_DONE;
+  return Z_OK;
+
+}
+
+void Transcoder::processPass(data::buffer::InlineReadData& dataIn) {
+  v_buff_size size = dataIn.bytesLeft;
+  if(size > m_bufferSize - m_bufferPos) {
+    size = m_bufferSize - m_bufferPos;
+  }
+  std::memcpy(m_buffer.get() + m_bufferPos, dataIn.currBufferPtr, size);
+  m_bufferPos += size;
+  dataIn.inc(size);
+}
+
+v_io_size Transcoder::suggestInputStreamReadSize() {
+  return m_bufferSize;
+}
+
+v_int32 Transcoder::iterate(data::buffer::InlineReadData& dataIn, data::buffer::InlineReadData& dataOut) {
+
+  if(dataOut.bytesLeft > 0) {
+    return Error::FLUSH_DATA_OUT;
+  }
+
+  if(m_finished){
+    dataOut.set(nullptr, 0);
+    return Error::FINISHED;
+  }
+
+  while(true) {
+
+    writeFrame();
+
+    if(m_bufferPos == m_bufferSize) {
+      dataOut.set(m_buffer.get(), m_bufferPos);
+      m_bufferPos = 0;
+      return Error::FLUSH_DATA_OUT;
+    }
+
+    if(dataIn.currBufferPtr == nullptr) {
+
+      if(m_state != STATE_DONE && m_state != STATE_PASS) {
+        /* input is truncated */
+        m_finished = true;
+        dataOut.set(nullptr, 0);
+        return ERROR_UNKNOWN;
+      }
+
+      if(m_framePos < m_frameSize) {
+        continue;
+      }
+
+      m_finished = true;
+
+      if(m_bufferPos > 0) {
+        dataOut.set(m_buffer.get(), m_bufferPos);
+        m_bufferPos = 0;
+        return Error::FLUSH_DATA_OUT;
+      }
+
+      dataOut.set(nullptr, 0);
+      return Error::FINISHED;
+
+    }
+
+    if(dataIn.bytesLeft == 0) {
+      return Error::PROVIDE_DATA_IN;
+    }
+
+    v_int32 res = Z_OK;
+
+    switch(m_state) {
+      case STATE_HEADER: res = processHeader(dataIn); break;
+      case STATE_PAYLOAD: res = processPayload(dataIn); break;
+      case STATE_TRAILER: res = processTrailer(dataIn); break;
+      case STATE_PASS: processPass(dataIn); break;
+      default:
+        /* data after the end of stream - further gzip members can't be joined without re-compression */
+        res = Z_DATA_ERROR;
+    }
+
+    if(res != Z_OK) {
+      m_finished = true;
+      dataOut.set(nullptr, 0);
+      return ERROR_UNKNOWN;
+    }
+
+  }
+
+}
+
+}}
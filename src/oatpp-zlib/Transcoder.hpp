@@ -0,0 +1,114 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#ifndef oatpp_zlib_Transcoder_hpp
+#define oatpp_zlib_Transcoder_hpp
+
+#include "oatpp/data/buffer/Processor.hpp"
+
+#include "zlib.h"
+#include <memory>
+
+namespace oatpp { namespace zlib {
+
+/**
+ * Gzip <-> zlib-wrapped deflate transcoder. <br>
+ * Both formats carry the same raw deflate payload - the transcoder only swaps header and trailer.
+ * Input format (gzip or zlib) is detected automatically. <br>
+ * Deflate payload is decoded only to compute the checksum of the output format - it is never re-compressed.
+ * The input trailer (checksum and length) is verified - &l:Transcoder::ERROR_UNKNOWN; is returned on mismatch,
+ * on truncated input, and on data after the end of the stream (ex.: further gzip members). <br>
+ * If input is already in the output format it is forwarded as-is, without verification.
+ */
+class Transcoder : public oatpp::data::buffer::Processor {
+public:
+  static constexpr v_int32 ERROR_UNKNOWN = 100;
+private:
+
+  enum State : v_int32 {
+    STATE_HEADER = 0,
+    STATE_PAYLOAD = 1,
+    STATE_TRAILER = 2,
+    STATE_PASS = 3,
+    STATE_DONE = 4
+  };
+
+private:
+  void writeFrame();
+  v_int32 processHeader(data::buffer::InlineReadData& dataIn);
+  v_int32 processPayload(data::buffer::InlineReadData& dataIn);
+  v_int32 processTrailer(data::buffer::InlineReadData& dataIn);
+  void processPass(data::buffer::InlineReadData& dataIn);
+private:
+  std::unique_ptr<v_char8[]> m_buffer;
+  v_buff_size m_bufferSize;
+  v_buff_size m_bufferPos;
+  std::unique_ptr<v_char8[]> m_scratch;
+private:
+  v_char8 m_frame[10];
+  v_buff_size m_framePos;
+  v_buff_size m_frameSize;
+private:
+  bool m_gzip;
+  bool m_inGzip;
+  v_char8 m_trailer[8];
+  v_buff_size m_trailerSize;
+  v_buff_size m_trailerPos;
+  uLong m_check;
+  uLong m_inCheck;
+  v_int32 m_state;
+  bool m_finished;
+  z_stream m_zStream;
+public:
+
+  /**
+   * Constructor.
+   * @param bufferSize
+   * @param gzip - output format. `true` - gzip, `false` - zlib-wrapped deflate.
+   */
+  Transcoder(v_buff_size bufferSize = 1024, bool gzip = false);
+
+  ~Transcoder();
+
+  /**
+   * If the client is using the input stream to read data and push it to the processor,
+   * the client MAY ask the processor for a suggested read size.
+   * @return - suggested read size.
+   */
+  v_io_size suggestInputStreamReadSize() override;
+
+  /**
+   * Process data.
+   * @param dataIn - data provided by client to processor. Input data. &id:data::buffer::InlineReadData;.
+   * Set `dataIn` buffer pointer to `nullptr` to designate the end of input.
+   * @param dataOut - data provided to client by processor. Output data. &id:data::buffer::InlineReadData;.
+   * @return - &l:Processor::Error;.
+   */
+  v_int32 iterate(data::buffer::InlineReadData& dataIn, data::buffer::InlineReadData& dataOut) override;
+
+};
+
+}}
+
+#endif // oatpp_zlib_Transcoder_hpp
@@ -0,0 +1,226 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#include "Vectored.hpp"
+
+#if defined(WIN32) || defined(_WIN32)
+  #include <winsock2.h>
+#else
+  #include <sys/uio.h>
+  #include <unistd.h>
+  #include <climits>
+  #include <cerrno>
+#endif
+
+namespace oatpp { namespace zlib {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// HandleSegmentWriter
+
+HandleSegmentWriter::HandleSegmentWriter(v_io_handle handle)
+  : m_handle(handle)
+  , m_writeCalls(0)
+{}
+
+#if defined(WIN32) || defined(_WIN32)
+
+v_io_size HandleSegmentWriter::writeSegments(const OutputSegment* segments, v_int32 count) {
+
+  v_io_size total = 0;
+
+  for(v_int32 i = 0; i < count; i ++) {
+    auto data = (const char*) segments[i].data;
+    v_buff_size left = segments[i].size;
+    while(left > 0) {
+      m_writeCalls ++;
+      auto res = ::send(m_handle, data, (int) left, 0);
+      if(res < 0 && WSAGetLastError() == WSAEWOULDBLOCK) {
+        return IOError::RETRY_WRITE;
+      } else if(res <= 0) {
+        return IOError::BROKEN_PIPE;
+      }
+      data += res;
+      left -= res;
+      total += res;
+    }
+  }
+
+  return total;
+
+}
+
+#else
+
+v_io_size HandleSegmentWriter::writeSegments(const OutputSegment* segments, v_int32 count) {
+
+  struct iovec vec[IOV_MAX];
+  v_io_size total = 0;
+
+  v_int32 index = 0;
+  v_buff_size offset = 0; // offset in segments[index] after partial write
+
+  while(index < count) {
+
+    v_int32 vecCount = 0;
+    for(v_int32 i = index; i < count && vecCount < IOV_MAX; i ++) {
+      v_buff_size skip = (i == index) ? offset : 0;
+      vec[vecCount].iov_base = (void*) ((const char*) segments[i].data + skip);
+      vec[vecCount].iov_len = (size_t) (segments[i].size - skip);
+      vecCount ++;
+    }
+
+    m_writeCalls ++;
+    ssize_t res = ::writev(m_handle, vec, vecCount);
+
+    if(res < 0) {
+      if(errno == EINTR) {
+        continue;
+      }
+      if(errno == EAGAIN || errno == EWOULDBLOCK) {
+        /* non-blocking handle - part of the segments may be written already, the write can't be resumed */
+        return IOError::RETRY_WRITE;
+      }
+      return IOError::BROKEN_PIPE;
+    } else if(res == 0) {
+      return IOError::BROKEN_PIPE;
+    }
+
+    total += res;
+
+    /* skip fully written segments */
+    v_buff_size written = res;
+    while(index < count && written >= segments[index].size - offset) {
+      written -= segments[index].size - offset;
+      offset = 0;
+      index ++;
+    }
+    offset += written;
+
+  }
+
+  return total;
+
+}
+
+#endif
+
+v_int64 HandleSegmentWriter::getWriteCallsCount() const {
+  return m_writeCalls;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// CallbackSegmentWriter
+
+CallbackSegmentWriter::CallbackSegmentWriter(const base::ObjectHandle<data::stream::WriteCallback>& writeCallback)
+  : m_writeCallback(writeCallback)
+{}
+
+v_io_size CallbackSegmentWriter::writeSegments(const OutputSegment* segments, v_int32 count) {
+  v_io_size total = 0;
+  for(v_int32 i = 0; i < count; i ++) {
+    auto res = m_writeCallback->writeExactSizeDataSimple(segments[i].data, segments[i].size);
+    if(res != segments[i].size) {
+      return res < 0 ? res : IOError::BROKEN_PIPE;
+    }
+    total += res;
+  }
+  return total;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// transferVectored
+
+v_io_size transferVectored(const base::ObjectHandle<data::stream::ReadCallback>& readCallback,
+                           const base::ObjectHandle<SegmentWriter>& segmentWriter,
+                           v_io_size transferSize,
+                           void* buffer,
+                           v_buff_size bufferSize,
+                           const base::ObjectHandle<VectoredProcessor>& processor)
+{
+
+  data::buffer::InlineReadData inData;
+  std::vector<OutputSegment> segments;
+
+  v_int32 procRes = data::buffer::Processor::Error::PROVIDE_DATA_IN;
+  v_io_size progress = 0;
+
+  while(true) {
+
+    if(procRes == data::buffer::Processor::Error::PROVIDE_DATA_IN && inData.bytesLeft == 0) {
+
+      v_buff_size desiredToRead = processor->suggestInputStreamReadSize();
+      if(desiredToRead > bufferSize) {
+        desiredToRead = bufferSize;
+      }
+      if(transferSize > 0 && desiredToRead > transferSize - progress) {
+        desiredToRead = transferSize - progress;
+      }
+
+      v_io_size res = 0;
+      if(desiredToRead > 0) {
+        res = readCallback->readSimple(buffer, desiredToRead);
+      }
+
+      if(res > 0) {
+        inData.set(buffer, res);
+        progress += res;
+      } else if(res == IOError::RETRY_READ || res == IOError::RETRY_WRITE) {
+        /* non-blocking stream - there is nothing to wait on here, fail instead of spinning */
+        return res;
+      } else if(res == 0 || res == IOError::ZERO_VALUE) {
+        inData.set(nullptr, 0);
+      } else {
+        return res;
+      }
+
+    }
+
+    procRes = processor->iterateVectored(inData, segments);
+
+    switch(procRes) {
+
+      case data::buffer::Processor::Error::PROVIDE_DATA_IN:
+        break;
+
+      case data::buffer::Processor::Error::FLUSH_DATA_OUT: {
+        v_io_size res = segmentWriter->writeSegments(segments.data(), (v_int32) segments.size());
+        if(res < 0) {
+          return res;
+        }
+        break;
+      }
+
+      case data::buffer::Processor::Error::FINISHED:
+        return progress;
+
+      default:
+        return IOError::BROKEN_PIPE;
+
+    }
+
+  }
+
+}
+
+}}
@@ -0,0 +1,185 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#ifndef oatpp_zlib_Vectored_hpp
+#define oatpp_zlib_Vectored_hpp
+
+#include "oatpp/data/stream/Stream.hpp"
+#include "oatpp/data/buffer/Processor.hpp"
+
+#include <vector>
+
+namespace oatpp { namespace zlib {
+
+/**
+ * Output segment - pointer/size pair (same as `struct iovec`).
+ */
+struct OutputSegment {
+
+  /**
+   * Pointer to segment data.
+   */
+  const void* data;
+
+  /**
+   * Segment size.
+   */
+  v_buff_size size;
+
+};
+
+/**
+ * Processor which is able to hand out several filled output buffers at once.
+ */
+class VectoredProcessor {
+public:
+
+  /**
+   * Default virtual destructor.
+   */
+  virtual ~VectoredProcessor() = default;
+
+  /**
+   * If the client is using the input stream to read data and push it to the processor,
+   * the client MAY ask the processor for a suggested read size.
+   * @return - suggested read size.
+   */
+  virtual v_io_size suggestInputStreamReadSize() = 0;
+
+  /**
+   * Process data handing out all filled output buffers at once. <br>
+   * Segments stay valid until the next call to `iterateVectored()` - the client has to consume all of them before.
+   * Don't mix calls to `iterateVectored()` and `iterate()` on the same processor.
+   * @param dataIn - data provided by client to processor. Input data. &id:data::buffer::InlineReadData;.
+   * Set `dataIn` buffer pointer to `nullptr` to designate the end of input.
+   * @param segments - output segments in order. The vector is cleared first.
+   * @return - &id:oatpp::data::buffer::Processor::Error;. `FLUSH_DATA_OUT` is returned when `segments` is not empty.
+   */
+  virtual v_int32 iterateVectored(data::buffer::InlineReadData& dataIn, std::vector<OutputSegment>& segments) = 0;
+
+};
+
+/**
+ * Segment writer - writes several segments with as few calls as possible.
+ */
+class SegmentWriter {
+public:
+
+  /**
+   * Default virtual destructor.
+   */
+  virtual ~SegmentWriter() = default;
+
+  /**
+   * Write all segments.
+   * @param segments - pointer to the first segment.
+   * @param count - number of segments.
+   * @return - total number of bytes written or negative value in case of error.
+   */
+  virtual v_io_size writeSegments(const OutputSegment* segments, v_int32 count) = 0;
+
+};
+
+/**
+ * Segment writer for a blocking I/O handle (socket or file). <br>
+ * Uses a single `writev()` call for up to `IOV_MAX` segments. On Windows segments are written one by one. <br>
+ * Non-blocking handles are not supported - `EAGAIN` fails the write with `IOError::RETRY_WRITE`.
+ */
+class HandleSegmentWriter : public SegmentWriter {
+private:
+  v_io_handle m_handle;
+  v_int64 m_writeCalls;
+public:
+
+  /**
+   * Constructor.
+   * @param handle - blocking I/O handle.
+   */
+  HandleSegmentWriter(v_io_handle handle);
+
+  /**
+   * Write all segments.
+   * @param segments - pointer to the first segment.
+   * @param count - number of segments.
+   * @return - total number of bytes written or negative value in case of error.
+   * `IOError::RETRY_WRITE` if the handle would block - segments may be partially written at this point.
+   */
+  v_io_size writeSegments(const OutputSegment* segments, v_int32 count) override;
+
+  /**
+   * Get number of write system calls made so far.
+   * @return
+   */
+  v_int64 getWriteCallsCount() const;
+
+};
+
+/**
+ * Segment writer for &id:oatpp::data::stream::WriteCallback;. <br>
+ * Fallback for streams without a native handle - segments are written one by one.
+ */
+class CallbackSegmentWriter : public SegmentWriter {
+private:
+  base::ObjectHandle<data::stream::WriteCallback> m_writeCallback;
+public:
+
+  /**
+   * Constructor.
+   * @param writeCallback
+   */
+  CallbackSegmentWriter(const base::ObjectHandle<data::stream::WriteCallback>& writeCallback);
+
+  /**
+   * Write all segments.
+   * @param segments - pointer to the first segment.
+   * @param count - number of segments.
+   * @return - total number of bytes written or negative value in case of error.
+   */
+  v_io_size writeSegments(const OutputSegment* segments, v_int32 count) override;
+
+};
+
+/**
+ * Transfer data from `readCallback` to `segmentWriter` through the vectored processor.
+ * Same as `oatpp::data::stream::transfer()` but all output segments available are written at once. <br>
+ * Blocking streams only - `IOError::RETRY_READ` and `IOError::RETRY_WRITE` from the `readCallback`
+ * or the `segmentWriter` are returned as errors.
+ * @param readCallback - &id:oatpp::data::stream::ReadCallback;.
+ * @param segmentWriter - &l:SegmentWriter;.
+ * @param transferSize - how much data should be read from the `readCallback`. `0` - to read until error.
+ * @param buffer - pointer to a buffer used to read data from `readCallback`.
+ * @param bufferSize - size of the buffer.
+ * @param processor - &l:VectoredProcessor;.
+ * @return - amount of bytes read from the `readCallback` or negative value in case of error.
+ */
+v_io_size transferVectored(const base::ObjectHandle<data::stream::ReadCallback>& readCallback,
+                           const base::ObjectHandle<SegmentWriter>& segmentWriter,
+                           v_io_size transferSize,
+                           void* buffer,
+                           v_buff_size bufferSize,
+                           const base::ObjectHandle<VectoredProcessor>& processor);
+
+}}
+
+#endif // oatpp_zlib_Vectored_hpp
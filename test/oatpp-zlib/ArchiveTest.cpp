@@ -0,0 +1,344 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#include "ArchiveTest.hpp"
+
+#include "oatpp-zlib/Archive.hpp"
+#include "oatpp/utils/Random.hpp"
+#include "oatpp/data/stream/BufferStream.hpp"
+
+#include "oatpp-test/Checker.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+namespace oatpp { namespace test { namespace zlib {
+
+namespace {
+
+struct Entry {
+  std::string name;
+  oatpp::String data;
+};
+
+/* stream which doesn't tell its size - returns data in small random-sized chunks */
+class ChunkedStream : public oatpp::data::stream::ReadCallback {
+private:
+  oatpp::String m_data;
+  v_buff_size m_pos = 0;
+public:
+
+  ChunkedStream(const oatpp::String& data) : m_data(data) {}
+
+  v_io_size read(void *buffer, v_buff_size count, async::Action& action) override {
+    v_buff_size size = std::min<v_buff_size>(count, (v_buff_size) m_data->size() - m_pos);
+    size = std::min<v_buff_size>(size, 1 + (m_pos * 7919) % 3000);
+    std::memcpy(buffer, m_data->data() + m_pos, size);
+    m_pos += size;
+    return size;
+  }
+
+};
+
+oatpp::String generateText(v_buff_size size) {
+  oatpp::data::stream::BufferOutputStream stream;
+  v_int64 counter = 0;
+  while(stream.getCurrentPosition() < size) {
+    auto line = "row " + std::to_string(counter ++ % 113) + " - exported report data\n";
+    stream.writeSimple(line.data(), (v_buff_size) line.size());
+  }
+  stream.setCurrentPosition(size);
+  return stream.toString();
+}
+
+oatpp::String readAll(oatpp::data::stream::ReadCallback& stream) {
+  oatpp::data::stream::BufferOutputStream out;
+  v_char8 buffer[1000];
+  while(true) {
+    auto res = stream.readSimple(buffer, sizeof(buffer));
+    OATPP_ASSERT(res >= 0);
+    if(res == 0) {
+      break;
+    }
+    out.writeSimple(buffer, res);
+  }
+  return out.toString();
+}
+
+oatpp::String inflate(const char* data, v_buff_size size, oatpp::zlib::Format format) {
+  oatpp::data::stream::BufferInputStream inStream(oatpp::String(data, size));
+  oatpp::data::stream::BufferOutputStream outStream;
+  oatpp::data::buffer::IOBuffer buffer;
+  oatpp::zlib::DeflateDecoder decoder(4096, format);
+  auto res = oatpp::data::stream::transfer(&inStream, &outStream, 0, buffer.getData(), buffer.getSize(), &decoder);
+  OATPP_ASSERT(res == size);
+  return outStream.toString();
+}
+
+v_uint64 getU(const std::string& data, size_t pos, v_int32 bytes) {
+  v_uint64 value = 0;
+  for(v_int32 i = bytes - 1; i >= 0; i --) {
+    value = (value << 8) | (v_uint8) data[pos + i];
+  }
+  return value;
+}
+
+void checkZip(const oatpp::String& archive, const std::vector<Entry>& entries) {
+
+  const std::string& zip = *archive;
+
+  /* end of central directory */
+  size_t eocd = zip.size() - 22;
+  OATPP_ASSERT(getU(zip, eocd, 4) == 0x06054b50);
+
+  v_uint64 count = getU(zip, eocd + 10, 2);
+  v_uint64 directoryOffset = getU(zip, eocd + 16, 4);
+
+  if(count == 0xFFFF || directoryOffset == 0xFFFFFFFF) {
+    size_t locator = eocd - 20;
+    OATPP_ASSERT(getU(zip, locator, 4) == 0x07064b50);
+    size_t eocd64 = getU(zip, locator + 8, 8);
+    OATPP_ASSERT(getU(zip, eocd64, 4) == 0x06064b50);
+    count = getU(zip, eocd64 + 32, 8);
+    directoryOffset = getU(zip, eocd64 + 48, 8);
+  }
+
+  OATPP_ASSERT(count == entries.size());
+
+  size_t pos = directoryOffset;
+
+  for(auto& entry : entries) {
+
+    OATPP_ASSERT(getU(zip, pos, 4) == 0x02014b50);
+    OATPP_ASSERT(getU(zip, pos + 10, 2) == 8);
+
+    v_uint32 crc = (v_uint32) getU(zip, pos + 16, 4);
+    v_uint64 compressedSize = getU(zip, pos + 20, 4);
+    v_uint64 size = getU(zip, pos + 24, 4);
+    size_t nameSize = getU(zip, pos + 28, 2);
+    size_t extraSize = getU(zip, pos + 30, 2);
+    v_uint64 offset = getU(zip, pos + 42, 4);
+
+    OATPP_ASSERT(zip.substr(pos + 46, nameSize) == entry.name);
+
+    if(extraSize > 0) {
+      size_t extra = pos + 46 + nameSize;
+      OATPP_ASSERT(getU(zip, extra, 2) == 1);
+      size = getU(zip, extra + 4, 8);
+      compressedSize = getU(zip, extra + 12, 8);
+      offset = getU(zip, extra + 20, 8);
+    }
+
+    /* local header */
+    OATPP_ASSERT(getU(zip, offset, 4) == 0x04034b50);
+    OATPP_ASSERT((getU(zip, offset + 6, 2) & 0x0008) != 0);
+    size_t dataOffset = offset + 30 + getU(zip, offset + 26, 2) + getU(zip, offset + 28, 2);
+
+    auto data = inflate(zip.data() + dataOffset, compressedSize, oatpp::zlib::Format::RAW);
+    OATPP_ASSERT(data == entry.data);
+    OATPP_ASSERT(size == data->size());
+    OATPP_ASSERT(crc == crc32(0, (const Bytef*) data->data(), (uInt) data->size()));
+
+    /* data descriptor */
+    OATPP_ASSERT(getU(zip, dataOffset + compressedSize, 4) == 0x08074b50);
+    OATPP_ASSERT(getU(zip, dataOffset + compressedSize + 4, 4) == crc);
+
+    pos += 46 + nameSize + extraSize;
+
+  }
+
+}
+
+void checkTarGz(const oatpp::String& archive, const std::vector<Entry>& entries) {
+
+  auto tarString = inflate(archive->data(), archive->size(), oatpp::zlib::Format::GZIP);
+  const std::string& tar = *tarString;
+
+  OATPP_ASSERT(tar.size() % 512 == 0);
+
+  size_t pos = 0;
+
+  for(auto& entry : entries) {
+
+    std::string name;
+
+    if(tar[pos + 156] == 'x') {
+      /* PAX header - "<length> path=<name>\n" */
+      size_t size = std::strtoull(tar.data() + pos + 124, nullptr, 8);
+      std::string pax = tar.substr(pos + 512, size);
+      auto start = pax.find(" path=") + 6;
+      name = pax.substr(start, pax.find('\n', start) - start);
+      pos += 512 + (size + 511) / 512 * 512;
+    }
+
+    OATPP_ASSERT(tar[pos + 156] == '0');
+    OATPP_ASSERT(std::memcmp(tar.data() + pos + 257, "ustar", 6) == 0);
+
+    if(name.empty()) {
+      std::string prefix(tar.data() + pos + 345, strnlen(tar.data() + pos + 345, 155));
+      name = std::string(tar.data() + pos, strnlen(tar.data() + pos, 100));
+      if(!prefix.empty()) {
+        name = prefix + "/" + name;
+      }
+    }
+
+    OATPP_ASSERT(name == entry.name);
+
+    v_uint32 checksum = 0;
+    for(v_int32 i = 0; i < 512; i ++) {
+      checksum += (i >= 148 && i < 156) ? ' ' : (v_uint8) tar[pos + i];
+    }
+    OATPP_ASSERT(checksum == std::strtoul(tar.data() + pos + 148, nullptr, 8));
+
+    size_t size = std::strtoull(tar.data() + pos + 124, nullptr, 8);
+    OATPP_ASSERT(size == entry.data->size());
+    OATPP_ASSERT(tar.substr(pos + 512, size) == *entry.data);
+
+    pos += 512 + (size + 511) / 512 * 512;
+
+  }
+
+  OATPP_ASSERT(tar.size() - pos == 1024);
+  OATPP_ASSERT(tar.substr(pos) == std::string(1024, '\0'));
+
+}
+
+std::vector<oatpp::zlib::ArchiveEntry> createEntries(const std::vector<Entry>& entries, bool knownSize, const char* filename) {
+
+  std::vector<oatpp::zlib::ArchiveEntry> result;
+
+  for(auto& entry : entries) {
+    if(filename != nullptr && entry.name == "file.txt") {
+      result.push_back(oatpp::zlib::ArchiveEntry::createFromFile(entry.name, filename, 1700000000));
+    } else {
+      result.push_back(oatpp::zlib::ArchiveEntry::createFromStream(entry.name,
+                                                                   std::make_shared<ChunkedStream>(entry.data),
+                                                                   knownSize ? (v_int64) entry.data->size() : -1,
+                                                                   1700000000));
+    }
+  }
+
+  return result;
+
+}
+
+}
+
+void ArchiveTest::onRun() {
+
+  oatpp::String random(200 * 1024);
+  oatpp::utils::Random::randomBytes((p_char8)random->data(), random->size());
+
+  std::vector<Entry> entries = {
+    {"readme.txt", generateText(1000)},
+    {"empty.txt", oatpp::String("")},
+    {"data/random.bin", random},
+    {"data/report.csv", generateText(3 * 1024 * 1024 + 17)},
+    {"file.txt", generateText(100 * 1024)},
+    {"very/long/path/" + std::string(90, 'd') + "/" + std::string(90, 'f') + ".txt", generateText(511)},
+    {std::string(120, 'n') + ".txt", generateText(512)}
+  };
+
+  /* unique file in the temp directory - removed when the test is done */
+  v_uint64 suffix;
+  oatpp::utils::Random::randomBytes((p_char8) &suffix, sizeof(suffix));
+  auto path = std::filesystem::temp_directory_path() / ("oatpp-zlib-archive-test-" + std::to_string(suffix) + ".txt");
+  auto pathString = path.string();
+  const char* filename = pathString.c_str();
+
+  struct FileGuard {
+    std::filesystem::path path;
+    ~FileGuard() {
+      std::error_code ec;
+      std::filesystem::remove(path, ec);
+    }
+  } fileGuard {path};
+
+  {
+    std::FILE* file = std::fopen(filename, "wb");
+    OATPP_ASSERT(file != nullptr);
+    auto& data = entries[4].data;
+    OATPP_ASSERT(std::fwrite(data->data(), 1, data->size(), file) == data->size());
+    std::fclose(file);
+  }
+
+  {
+    oatpp::test::PerformanceChecker timer("ZIP - known sizes");
+    oatpp::zlib::StreamingArchive archive(oatpp::zlib::ArchiveFormat::ZIP, createEntries(entries, true, filename));
+    checkZip(readAll(archive), entries);
+  }
+
+  {
+    oatpp::test::PerformanceChecker timer("ZIP - unknown sizes (ZIP64 descriptors)");
+    oatpp::zlib::StreamingArchive archive(oatpp::zlib::ArchiveFormat::ZIP, createEntries(entries, false, nullptr), Z_BEST_SPEED, 4096);
+    checkZip(readAll(archive), entries);
+  }
+
+  {
+    oatpp::test::PerformanceChecker timer("tar.gz");
+    oatpp::zlib::StreamingArchive archive(oatpp::zlib::ArchiveFormat::TAR_GZ, createEntries(entries, true, filename));
+    checkTarGz(readAll(archive), entries);
+  }
+
+  {
+    /* many entries - ZIP64 end of central directory */
+    std::vector<Entry> many;
+    for(v_int32 i = 0; i < 70000; i ++) {
+      many.push_back({"f" + std::to_string(i), oatpp::String(std::to_string(i))});
+    }
+    oatpp::test::PerformanceChecker timer("ZIP - 70000 entries");
+    oatpp::zlib::StreamingArchive archive(oatpp::zlib::ArchiveFormat::ZIP, createEntries(many, true, nullptr), Z_BEST_SPEED, 1024);
+    checkZip(readAll(archive), many);
+  }
+
+  {
+    /* tar requires known sizes */
+    bool thrown = false;
+    try {
+      oatpp::zlib::StreamingArchive archive(oatpp::zlib::ArchiveFormat::TAR_GZ, createEntries(entries, false, nullptr));
+    } catch (std::runtime_error& e) {
+      thrown = true;
+    }
+    OATPP_ASSERT(thrown);
+  }
+
+  {
+    /* declared size doesn't match the data */
+    std::vector<oatpp::zlib::ArchiveEntry> bad = {
+      oatpp::zlib::ArchiveEntry::createFromStream("bad.txt", std::make_shared<ChunkedStream>(generateText(100)), 200)
+    };
+    oatpp::zlib::StreamingArchive zip(oatpp::zlib::ArchiveFormat::ZIP, bad);
+    oatpp::zlib::StreamingArchive tar(oatpp::zlib::ArchiveFormat::TAR_GZ, bad);
+    v_char8 buffer[1000];
+    v_io_size res;
+    while((res = zip.readSimple(buffer, sizeof(buffer))) > 0) {}
+    OATPP_ASSERT(res < 0);
+    while((res = tar.readSimple(buffer, sizeof(buffer))) > 0) {}
+    OATPP_ASSERT(res < 0);
+  }
+
+}
+
+}}}
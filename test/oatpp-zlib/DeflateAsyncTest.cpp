@@ -36,7 +36,7 @@ namespace {
 
 class TestCoroutine : public oatpp::async::Coroutine<TestCoroutine> {
 private:
-  bool m_gzip;
+  oatpp::zlib::Format m_format;
 private:
   oatpp::String m_original;
   oatpp::data::stream::BufferInputStream m_inStream;
@@ -46,8 +46,8 @@ private:
   v_int32 m_d;
 public:
 
-  TestCoroutine(bool gzip)
-    : m_gzip(gzip)
+  TestCoroutine(oatpp::zlib::Format format)
+    : m_format(format)
     , m_original(1024)
     , m_inStream(m_original)
     , m_e(1)
@@ -74,8 +74,8 @@ public:
   }
 
   Action runPipeline() {
-    auto encoder = std::make_shared<oatpp::zlib::DeflateEncoder>(m_e, m_gzip);
-    auto decoder = std::make_shared<oatpp::zlib::DeflateDecoder>(m_d, m_gzip);
+    auto encoder = std::make_shared<oatpp::zlib::DeflateEncoder>(m_e, m_format);
+    auto decoder = std::make_shared<oatpp::zlib::DeflateDecoder>(m_d, m_format);
 
     auto pipeline = std::shared_ptr<oatpp::data::buffer::Processor>(new oatpp::data::buffer::ProcessingPipeline({
       oatpp::base::ObjectHandle<oatpp::data::buffer::Processor>(encoder),
@@ -110,8 +110,9 @@ void DeflateAsyncTest::onRun() {
 
   oatpp::async::Executor executor;
 
-  executor.execute<TestCoroutine>(false);
-  executor.execute<TestCoroutine>(true);
+  executor.execute<TestCoroutine>(oatpp::zlib::Format::ZLIB);
+  executor.execute<TestCoroutine>(oatpp::zlib::Format::GZIP);
+  executor.execute<TestCoroutine>(oatpp::zlib::Format::RAW);
 
   executor.waitTasksFinished();
   executor.stop();
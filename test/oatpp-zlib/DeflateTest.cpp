@@ -24,17 +24,25 @@
 
 #include "DeflateTest.hpp"
 
+#include "oatpp-zlib/EncoderProvider.hpp"
 #include "oatpp-zlib/Processor.hpp"
 #include "oatpp/utils/Random.hpp"
 #include "oatpp/data/stream/BufferStream.hpp"
 
 #include "oatpp-test/Checker.hpp"
 
+#include <cstdio>
+
+#if !defined(WIN32) && !defined(_WIN32)
+  #include <unistd.h>
+  #include <fcntl.h>
+#endif
+
 namespace oatpp { namespace test { namespace zlib {
 
 namespace {
 
-void runCompressorPipeline (bool gzip) {
+void runCompressorPipeline (oatpp::zlib::Format format) {
 
   for (v_int32 e = 1; e <= 64; e++) {
     for (v_int32 d = 1; d <= 64; d++) {
@@ -45,8 +53,8 @@ void runCompressorPipeline (bool gzip) {
       oatpp::data::stream::BufferInputStream inStream(original);
       oatpp::data::stream::BufferOutputStream outStream;
 
-      oatpp::zlib::DeflateEncoder encoder(e, gzip);
-      oatpp::zlib::DeflateDecoder decoder(d, gzip);
+      oatpp::zlib::DeflateEncoder encoder(e, format);
+      oatpp::zlib::DeflateDecoder decoder(d, format);
 
       oatpp::data::buffer::ProcessingPipeline pipeline({
                                                          &encoder,
@@ -69,7 +77,7 @@ void runCompressorPipeline (bool gzip) {
 
 }
 
-void runCompressor (bool gzip) {
+void runCompressor (oatpp::zlib::Format format) {
 
   for (v_int32 e = 1; e <= 64; e++) {
     for (v_int32 d = 1; d <= 64; d++) {
@@ -82,14 +90,14 @@ void runCompressor (bool gzip) {
       oatpp::data::stream::BufferInputStream inStream(original);
       oatpp::data::stream::BufferOutputStream outEncoded;
 
-      oatpp::zlib::DeflateEncoder encoder(e, gzip);
+      oatpp::zlib::DeflateEncoder encoder(e, format);
 
       oatpp::data::stream::transfer(&inStream, &outEncoded, 0, buffer.getData(), buffer.getSize(), &encoder);
 
       oatpp::data::stream::BufferInputStream inEncoded(outEncoded.toString());
       oatpp::data::stream::BufferOutputStream outStream;
 
-      oatpp::zlib::DeflateDecoder decoder(d, gzip);
+      oatpp::zlib::DeflateDecoder decoder(d, format);
 
       oatpp::data::stream::transfer(&inEncoded, &outStream, 0, buffer.getData(), buffer.getSize(), &decoder);
 
@@ -106,28 +114,807 @@ void runCompressor (bool gzip) {
 
 }
 
+void runAdaptiveStrategyRandom (oatpp::zlib::Format format) {
+
+  const v_buff_size windowSize = 32 * 1024;
+  const v_buff_size chunkSize = 4 * 1024;
+
+  oatpp::String original(windowSize * 16);
+  oatpp::utils::Random::randomBytes((p_char8)original->data(), original->size());
+
+  oatpp::zlib::DeflateEncoder::AdaptiveStrategy strategy;
+  strategy.windowSize = windowSize;
+  strategy.storedWindows = 4;
+
+  oatpp::zlib::DeflateEncoder encoder(2048, format);
+  encoder.setAdaptiveStrategy(strategy);
+
+  oatpp::data::stream::BufferOutputStream outEncoded;
+  v_buff_size detectedAt = -1;
+
+  for(v_buff_size pos = 0; pos < (v_buff_size) original->size(); pos += chunkSize) {
+
+    data::buffer::InlineReadData dataIn(original->data() + pos, chunkSize);
+    data::buffer::InlineReadData dataOut;
+    while(encoder.iterate(dataIn, dataOut) == oatpp::data::buffer::Processor::Error::FLUSH_DATA_OUT) {
+      outEncoded.writeSimple(dataOut.currBufferPtr, dataOut.bytesLeft);
+      dataOut.setEof();
+    }
+
+    if(detectedAt < 0 && encoder.getStrategyMode() != oatpp::zlib::DeflateEncoder::MODE_NORMAL) {
+      detectedAt = pos + chunkSize;
+    }
+
+    /* random data never looks compressible */
+    if(detectedAt >= 0) {
+      OATPP_ASSERT(encoder.getStrategyMode() != oatpp::zlib::DeflateEncoder::MODE_NORMAL);
+    }
+
+  }
+
+  /* detected right after the first window */
+  OATPP_ASSERT(detectedAt > 0 && detectedAt <= windowSize + chunkSize);
+
+  data::buffer::InlineReadData end(nullptr, 0);
+  data::buffer::InlineReadData dataOut;
+  while(encoder.iterate(end, dataOut) == oatpp::data::buffer::Processor::Error::FLUSH_DATA_OUT) {
+    outEncoded.writeSimple(dataOut.currBufferPtr, dataOut.bytesLeft);
+    dataOut.setEof();
+  }
+
+  oatpp::data::buffer::IOBuffer buffer;
+  oatpp::data::stream::BufferInputStream inEncoded(outEncoded.toString());
+  oatpp::data::stream::BufferOutputStream outStream;
+  oatpp::zlib::DeflateDecoder decoder(2048, format);
+  oatpp::data::stream::transfer(&inEncoded, &outStream, 0, buffer.getData(), buffer.getSize(), &decoder);
+  OATPP_ASSERT(outStream.toString() == original);
+
+}
+
+oatpp::String generateMixedContent() {
+
+  oatpp::data::stream::BufferOutputStream stream;
+
+  auto writeText = [&stream](v_buff_size size) {
+    v_buff_size end = stream.getCurrentPosition() + size;
+    v_int64 counter = 0;
+    while(stream.getCurrentPosition() < end) {
+      auto line = "line " + std::to_string(counter ++ % 97) + " - some compressible text\n";
+      stream.writeSimple(line.data(), (v_buff_size) line.size());
+    }
+  };
+
+  writeText(256 * 1024);
+
+  oatpp::String random(512 * 1024);
+  oatpp::utils::Random::randomBytes((p_char8)random->data(), random->size());
+  stream.writeSimple(random->data(), (v_buff_size) random->size());
+
+  writeText(256 * 1024);
+
+  return stream.toString();
+
+}
+
+void runAdaptiveStrategy (oatpp::zlib::Format format, const oatpp::String& original) {
+
+  for (v_int32 e : {1, 7, 64, 2048}) {
+
+    oatpp::data::stream::BufferInputStream inStream(original);
+    oatpp::data::stream::BufferOutputStream outStream;
+
+    oatpp::zlib::DeflateEncoder::AdaptiveStrategy strategy;
+    strategy.windowSize = 32 * 1024;
+    strategy.storedWindows = 4;
+
+    oatpp::zlib::DeflateEncoder encoder(e, format);
+    encoder.setAdaptiveStrategy(strategy);
+    oatpp::zlib::DeflateDecoder decoder(e, format);
+
+    oatpp::data::buffer::ProcessingPipeline pipeline({
+                                                       &encoder,
+                                                       &decoder
+                                                     });
+
+    oatpp::data::buffer::IOBuffer buffer;
+    oatpp::data::stream::transfer(&inStream, &outStream, 0, buffer.getData(), buffer.getSize(), &pipeline);
+
+    OATPP_ASSERT(outStream.toString() == original);
+
+    /* normal -> huffman-only -> stored -> ... -> normal */
+    OATPP_ASSERT(encoder.getStrategyModeSwitchCount() >= 3);
+    OATPP_ASSERT(encoder.getStrategyMode() == oatpp::zlib::DeflateEncoder::MODE_NORMAL);
+
+  }
+
+}
+
+void runInputCoalescing (oatpp::zlib::Format format, const oatpp::String& original, v_buff_size threshold) {
+
+  for (v_int32 e : {1, 7, 64}) {
+
+    oatpp::zlib::DeflateEncoder encoder(2048, format);
+    encoder.setInputCoalescing(threshold);
+    OATPP_ASSERT(encoder.suggestInputStreamReadSize() == (threshold > 0 ? threshold : 2048));
+
+    oatpp::data::stream::BufferOutputStream outEncoded;
+
+    /* input comes in tiny chunks */
+    for(v_buff_size pos = 0; pos < (v_buff_size) original->size() + e; pos += e) {
+
+      data::buffer::InlineReadData dataIn;
+      if(pos < (v_buff_size) original->size()) {
+        dataIn.set(original->data() + pos, std::min<v_buff_size>(e, original->size() - pos));
+      } else {
+        dataIn.set(nullptr, 0);
+      }
+
+      data::buffer::InlineReadData dataOut;
+      while(encoder.iterate(dataIn, dataOut) == oatpp::data::buffer::Processor::Error::FLUSH_DATA_OUT) {
+        outEncoded.writeSimple(dataOut.currBufferPtr, dataOut.bytesLeft);
+        dataOut.setEof();
+      }
+      OATPP_ASSERT(dataIn.bytesLeft == 0);
+
+    }
+
+    oatpp::data::buffer::IOBuffer buffer;
+    oatpp::data::stream::BufferInputStream inEncoded(outEncoded.toString());
+    oatpp::data::stream::BufferOutputStream outStream;
+
+    oatpp::zlib::DeflateDecoder decoder(2048, format);
+    oatpp::data::stream::transfer(&inEncoded, &outStream, 0, buffer.getData(), buffer.getSize(), &decoder);
+
+    OATPP_ASSERT(outStream.toString() == original);
+
+  }
+
+}
+
+void runFlush (v_buff_size threshold) {
+
+  oatpp::zlib::DeflateEncoder encoder(16, oatpp::zlib::Format::RAW);
+  encoder.setInputCoalescing(threshold);
+
+  oatpp::data::stream::BufferOutputStream outEncoded;
+
+  auto process = [&encoder, &outEncoded](data::buffer::InlineReadData& dataIn) {
+    data::buffer::InlineReadData dataOut;
+    v_int32 res;
+    while((res = encoder.iterate(dataIn, dataOut)) == oatpp::zlib::DeflateEncoder::Error::FLUSH_DATA_OUT) {
+      outEncoded.writeSimple(dataOut.currBufferPtr, dataOut.bytesLeft);
+      dataOut.setEof();
+    }
+    return res;
+  };
+
+  std::string message = "Hello World!";
+
+  data::buffer::InlineReadData dataIn((void*) message.data(), (v_buff_size) message.size());
+  OATPP_ASSERT(process(dataIn) == oatpp::zlib::DeflateEncoder::Error::PROVIDE_DATA_IN);
+
+  encoder.flush();
+  OATPP_ASSERT(process(dataIn) == oatpp::zlib::DeflateEncoder::Error::PROVIDE_DATA_IN);
+
+  /* everything provided before flush() must be decodable */
+  auto encoded = outEncoded.toString();
+  OATPP_ASSERT(encoded->size() >= 4);
+  OATPP_ASSERT(encoded->substr(encoded->size() - 4) == std::string("\x00\x00\xff\xff", 4));
+
+  v_char8 decoded[64];
+  z_stream zStream;
+  zStream.zalloc = Z_NULL;
+  zStream.zfree = Z_NULL;
+  zStream.opaque = Z_NULL;
+  zStream.next_in = (Bytef *) encoded->data();
+  zStream.avail_in = (uInt) encoded->size();
+  OATPP_ASSERT(inflateInit2(&zStream, -15) == Z_OK);
+  zStream.next_out = decoded;
+  zStream.avail_out = 64;
+  OATPP_ASSERT(inflate(&zStream, Z_SYNC_FLUSH) == Z_OK);
+  OATPP_ASSERT(std::string((const char*) decoded, 64 - zStream.avail_out) == message);
+  inflateEnd(&zStream);
+
+  data::buffer::InlineReadData end(nullptr, 0);
+  OATPP_ASSERT(process(end) == oatpp::zlib::DeflateEncoder::Error::FINISHED);
+
+}
+
+void runOutputRing (oatpp::zlib::Format format, const oatpp::String& original) {
+
+  for (v_int32 count : {1, 2, 4}) {
+    for (v_int32 e : {1, 7, 64}) {
+
+      oatpp::zlib::DeflateEncoder encoder(e, format);
+      encoder.setOutputBufferCount(count);
+
+      oatpp::data::stream::BufferOutputStream outEncoded;
+
+      /* slow consumer - writes 3 bytes at a time and lets the encoder work in between */
+      data::buffer::InlineReadData dataIn;
+      data::buffer::InlineReadData dataOut;
+      v_buff_size inPos = 0;
+      v_int64 aheadCount = 0;
+
+      while(true) {
+
+        if(dataIn.bytesLeft == 0 && dataIn.currBufferPtr != nullptr) {
+          v_buff_size size = std::min<v_buff_size>(100, original->size() - inPos);
+          if(size > 0) {
+            dataIn.set(original->data() + inPos, size);
+            inPos += size;
+          } else {
+            dataIn.set(nullptr, 0);
+          }
+        } else if(dataIn.currBufferPtr == nullptr && inPos == 0) {
+          dataIn.set(original->data(), 100);
+          inPos = 100;
+        }
+
+        v_buff_size inBefore = dataIn.bytesLeft;
+        bool outBusy = dataOut.bytesLeft > 0;
+
+        auto res = encoder.iterate(dataIn, dataOut);
+
+        if(outBusy && dataIn.bytesLeft < inBefore) {
+          aheadCount ++;
+        }
+
+        if(res == oatpp::zlib::DeflateEncoder::Error::FINISHED) {
+          break;
+        }
+
+        OATPP_ASSERT(res == oatpp::zlib::DeflateEncoder::Error::FLUSH_DATA_OUT || res == oatpp::zlib::DeflateEncoder::Error::PROVIDE_DATA_IN);
+
+        if(dataOut.bytesLeft > 0) {
+          v_buff_size size = std::min<v_buff_size>(3, dataOut.bytesLeft);
+          outEncoded.writeSimple(dataOut.currBufferPtr, size);
+          dataOut.inc(size);
+        }
+
+      }
+
+      /* consumer is slower than 3 bytes per iteration only for buffers larger than 3 bytes */
+      if(count > 1 && e > 3) {
+        OATPP_ASSERT(aheadCount > 0);
+      }
+
+      oatpp::data::buffer::IOBuffer buffer;
+      oatpp::data::stream::BufferInputStream inEncoded(outEncoded.toString());
+      oatpp::data::stream::BufferOutputStream outStream;
+
+      oatpp::zlib::DeflateDecoder decoder(2048, format);
+      oatpp::data::stream::transfer(&inEncoded, &outStream, 0, buffer.getData(), buffer.getSize(), &decoder);
+
+      OATPP_ASSERT(outStream.toString() == original);
+
+    }
+  }
+
+}
+
+class CountingSegmentWriter : public oatpp::zlib::SegmentWriter {
+public:
+
+  oatpp::data::stream::BufferOutputStream stream;
+  v_int64 writeCalls = 0;
+
+  v_io_size writeSegments(const oatpp::zlib::OutputSegment* segments, v_int32 count) override {
+    writeCalls ++;
+    v_io_size total = 0;
+    for(v_int32 i = 0; i < count; i ++) {
+      stream.writeSimple(segments[i].data, segments[i].size);
+      total += segments[i].size;
+    }
+    return total;
+  }
+
+};
+
+/* non-blocking input which never has data */
+class RetryReader : public oatpp::data::stream::ReadCallback {
+public:
+
+  v_int64 readCalls = 0;
+
+  v_io_size read(void* buffer, v_buff_size count, oatpp::async::Action& action) override {
+    readCalls ++;
+    return oatpp::IOError::RETRY_READ;
+  }
+
+};
+
+void runVectored (oatpp::zlib::Format format, const oatpp::String& original) {
+
+  oatpp::data::buffer::IOBuffer buffer;
+  oatpp::String encoded;
+
+  {
+    oatpp::zlib::DeflateEncoder encoder(2048, format);
+    encoder.setOutputBufferCount(16);
+
+    oatpp::data::stream::BufferInputStream inStream(original);
+    CountingSegmentWriter writer;
+
+    auto res = oatpp::zlib::transferVectored(&inStream, &writer, 0, buffer.getData(), buffer.getSize(), &encoder);
+    OATPP_ASSERT(res == (v_io_size) original->size());
+
+    encoded = writer.stream.toString();
+    v_int64 chunks = (encoded->size() + 2047) / 2048;
+    OATPP_ASSERT(writer.writeCalls * 8 < chunks);
+  }
+
+#if !defined(WIN32) && !defined(_WIN32)
+
+  {
+    oatpp::zlib::DeflateDecoder decoder(2048, format);
+    decoder.setOutputBufferCount(16);
+
+    std::FILE* file = std::tmpfile();
+    OATPP_ASSERT(file != nullptr);
+
+    oatpp::data::stream::BufferInputStream inStream(encoded);
+    oatpp::zlib::HandleSegmentWriter writer(fileno(file));
+
+    auto res = oatpp::zlib::transferVectored(&inStream, &writer, 0, buffer.getData(), buffer.getSize(), &decoder);
+    OATPP_ASSERT(res == (v_io_size) encoded->size());
+
+    v_int64 chunks = (original->size() + 2047) / 2048;
+    OATPP_ASSERT(writer.getWriteCallsCount() * 8 < chunks);
+
+    oatpp::String check((v_buff_size) original->size());
+    std::rewind(file);
+    OATPP_ASSERT(std::fread((void*) check->data(), 1, check->size(), file) == check->size());
+    OATPP_ASSERT(std::fgetc(file) == EOF);
+    std::fclose(file);
+
+    OATPP_ASSERT(check == original);
+  }
+
+  {
+    /* non-blocking handle - a full pipe fails the write instead of reporting a broken pipe */
+    int fds[2];
+    OATPP_ASSERT(pipe(fds) == 0);
+    OATPP_ASSERT(fcntl(fds[1], F_SETFL, O_NONBLOCK) == 0);
+
+    oatpp::zlib::DeflateDecoder decoder(2048, format);
+    decoder.setOutputBufferCount(16);
+
+    oatpp::data::stream::BufferInputStream inStream(encoded);
+    oatpp::zlib::HandleSegmentWriter writer(fds[1]);
+
+    auto res = oatpp::zlib::transferVectored(&inStream, &writer, 0, buffer.getData(), buffer.getSize(), &decoder);
+    OATPP_ASSERT(res == oatpp::IOError::RETRY_WRITE);
+
+    close(fds[0]);
+    close(fds[1]);
+  }
+
+#endif
+
+  {
+    /* non-blocking input - the transfer fails instead of spinning */
+    oatpp::zlib::DeflateEncoder encoder(2048, format);
+    RetryReader reader;
+    CountingSegmentWriter writer;
+
+    auto res = oatpp::zlib::transferVectored(&reader, &writer, 0, buffer.getData(), buffer.getSize(), &encoder);
+    OATPP_ASSERT(res == oatpp::IOError::RETRY_READ);
+    OATPP_ASSERT(reader.readCalls == 1);
+  }
+
+  {
+    /* small ring - vectored decoder with the regular write callback */
+    oatpp::zlib::DeflateDecoder decoder(7, format);
+    decoder.setOutputBufferCount(3);
+
+    oatpp::data::stream::BufferInputStream inStream(encoded);
+    oatpp::data::stream::BufferOutputStream outStream;
+    oatpp::zlib::CallbackSegmentWriter writer(&outStream);
+
+    auto res = oatpp::zlib::transferVectored(&inStream, &writer, 0, buffer.getData(), buffer.getSize(), &decoder);
+    OATPP_ASSERT(res == (v_io_size) encoded->size());
+    OATPP_ASSERT(outStream.toString() == original);
+  }
+
+}
+
+/* feeds input in chunks of suggested read size, returns number of output chunks */
+v_int64 runAdaptiveProcessor(oatpp::data::buffer::Processor& processor, const oatpp::String& input,
+                             oatpp::data::stream::BufferOutputStream& output, oatpp::zlib::DeflateEncoder* flushEncoder = nullptr)
+{
+
+  v_int64 outCount = 0;
+  v_buff_size inPos = 0;
+
+  while(true) {
+
+    data::buffer::InlineReadData dataIn;
+    v_buff_size size = std::min<v_buff_size>(processor.suggestInputStreamReadSize(), input->size() - inPos);
+    if(size > 0) {
+      dataIn.set(input->data() + inPos, size);
+      inPos += size;
+      if(flushEncoder) {
+        flushEncoder->flush();
+      }
+    } else {
+      dataIn.set(nullptr, 0);
+    }
+
+    data::buffer::InlineReadData dataOut;
+    v_int32 res;
+    while((res = processor.iterate(dataIn, dataOut)) == oatpp::data::buffer::Processor::Error::FLUSH_DATA_OUT) {
+      output.writeSimple(dataOut.currBufferPtr, dataOut.bytesLeft);
+      dataOut.setEof();
+      outCount ++;
+    }
+
+    if(res == oatpp::data::buffer::Processor::Error::FINISHED) {
+      break;
+    }
+    OATPP_ASSERT(res == oatpp::data::buffer::Processor::Error::PROVIDE_DATA_IN);
+
+  }
+
+  return outCount;
+
+}
+
+void runAdaptiveBufferSize (oatpp::zlib::Format format) {
+
+  {
+    /* small response - buffer stays small */
+    oatpp::String original = "Hello World!";
+    oatpp::zlib::DeflateEncoder encoder(2048, format);
+    encoder.setAdaptiveBufferSize(512, 64 * 1024);
+    OATPP_ASSERT(encoder.suggestInputStreamReadSize() == 512);
+
+    oatpp::data::stream::BufferOutputStream outEncoded;
+    runAdaptiveProcessor(encoder, original, outEncoded);
+    OATPP_ASSERT(encoder.getOutputBufferSize() == 512);
+
+    oatpp::data::stream::BufferOutputStream outStream;
+    oatpp::zlib::DeflateDecoder decoder(2048, format);
+    runAdaptiveProcessor(decoder, outEncoded.toString(), outStream);
+    OATPP_ASSERT(outStream.toString() == original);
+  }
+
+  oatpp::String original(1024 * 1024);
+  oatpp::utils::Random::randomBytes((p_char8)original->data(), original->size());
+
+  v_int64 fixedCount;
+  oatpp::String encoded;
+
+  {
+    oatpp::zlib::DeflateEncoder encoder(512, format);
+    oatpp::data::stream::BufferOutputStream outEncoded;
+    fixedCount = runAdaptiveProcessor(encoder, original, outEncoded);
+  }
+
+  {
+    /* large response - buffer grows to max, fewer iterations */
+    oatpp::zlib::DeflateEncoder encoder(512, format);
+    encoder.setAdaptiveBufferSize(512, 64 * 1024);
+    oatpp::data::stream::BufferOutputStream outEncoded;
+    v_int64 adaptiveCount = runAdaptiveProcessor(encoder, original, outEncoded);
+    OATPP_ASSERT(encoder.getOutputBufferSize() == 64 * 1024);
+    OATPP_ASSERT(adaptiveCount * 8 < fixedCount);
+    encoded = outEncoded.toString();
+  }
+
+  {
+    /* decoder grows the same way and follows the compression ratio for read size */
+    oatpp::zlib::DeflateDecoder decoder(512, format);
+    decoder.setAdaptiveBufferSize(512, 64 * 1024);
+    oatpp::data::stream::BufferOutputStream outStream;
+    runAdaptiveProcessor(decoder, encoded, outStream);
+    OATPP_ASSERT(decoder.getOutputBufferSize() == 64 * 1024);
+    OATPP_ASSERT(outStream.toString() == original);
+  }
+
+  if(format == oatpp::zlib::Format::GZIP) {
+    /* read size follows the ratio of all gzip members - compressible member followed by a small incompressible one */
+    oatpp::String text(256 * 1024);
+    for(v_buff_size i = 0; i < (v_buff_size) text->size(); i ++) {
+      text->data()[i] = "compressible text line\n"[i % 23];
+    }
+    oatpp::String random(original->data(), 4096);
+
+    auto encodeMember = [](const oatpp::String& data) {
+      oatpp::data::stream::BufferInputStream inStream(data);
+      oatpp::data::stream::BufferOutputStream outStream;
+      oatpp::data::buffer::IOBuffer buffer;
+      oatpp::zlib::DeflateEncoder encoder(4096, oatpp::zlib::Format::GZIP);
+      oatpp::data::stream::transfer(&inStream, &outStream, 0, buffer.getData(), buffer.getSize(), &encoder);
+      return outStream.toString();
+    };
+    oatpp::String members(*encodeMember(text) + *encodeMember(random));
+
+    oatpp::zlib::DeflateDecoder decoder(512, format);
+    decoder.setAdaptiveBufferSize(512, 64 * 1024);
+
+    oatpp::data::stream::BufferOutputStream outStream;
+    data::buffer::InlineReadData dataIn(members->data(), members->size());
+    data::buffer::InlineReadData dataOut;
+    while(decoder.iterate(dataIn, dataOut) == oatpp::data::buffer::Processor::Error::FLUSH_DATA_OUT) {
+      outStream.writeSimple(dataOut.currBufferPtr, dataOut.bytesLeft);
+      dataOut.setEof();
+    }
+    OATPP_ASSERT(decoder.suggestInputStreamReadSize() < decoder.getOutputBufferSize() / 4);
+
+    data::buffer::InlineReadData end(nullptr, 0);
+    while(decoder.iterate(end, dataOut) == oatpp::data::buffer::Processor::Error::FLUSH_DATA_OUT) {
+      outStream.writeSimple(dataOut.currBufferPtr, dataOut.bytesLeft);
+      dataOut.setEof();
+    }
+    OATPP_ASSERT(outStream.toString() == oatpp::String(*text + *random));
+  }
+
+  {
+    /* frequent flushes of small messages - buffer shrinks back */
+    oatpp::zlib::DeflateEncoder encoder(512, format);
+    encoder.setAdaptiveBufferSize(512, 64 * 1024);
+
+    oatpp::data::stream::BufferOutputStream outEncoded;
+    data::buffer::InlineReadData dataIn(original->data(), original->size());
+    data::buffer::InlineReadData dataOut;
+    while(encoder.iterate(dataIn, dataOut) == oatpp::data::buffer::Processor::Error::FLUSH_DATA_OUT) {
+      outEncoded.writeSimple(dataOut.currBufferPtr, dataOut.bytesLeft);
+      dataOut.setEof();
+    }
+    OATPP_ASSERT(encoder.getOutputBufferSize() == 64 * 1024);
+
+    oatpp::String messages(16 * 1024);
+    for(v_buff_size i = 0; i < (v_buff_size) messages->size(); i ++) {
+      messages->data()[i] = "{\"event\": \"tick\"}\n"[i % 18];
+    }
+
+    for(v_buff_size pos = 0; pos < (v_buff_size) messages->size(); pos += 100) {
+      encoder.flush();
+      data::buffer::InlineReadData message(messages->data() + pos, std::min<v_buff_size>(100, messages->size() - pos));
+      while(encoder.iterate(message, dataOut) == oatpp::data::buffer::Processor::Error::FLUSH_DATA_OUT) {
+        outEncoded.writeSimple(dataOut.currBufferPtr, dataOut.bytesLeft);
+        dataOut.setEof();
+      }
+    }
+    OATPP_ASSERT(encoder.getOutputBufferSize() == 512);
+
+    data::buffer::InlineReadData end(nullptr, 0);
+    while(encoder.iterate(end, dataOut) == oatpp::data::buffer::Processor::Error::FLUSH_DATA_OUT) {
+      outEncoded.writeSimple(dataOut.currBufferPtr, dataOut.bytesLeft);
+      dataOut.setEof();
+    }
+
+    oatpp::data::stream::BufferOutputStream outStream;
+    oatpp::zlib::DeflateDecoder decoder(2048, format);
+    runAdaptiveProcessor(decoder, outEncoded.toString(), outStream);
+    OATPP_ASSERT(outStream.toString() == *original + *messages);
+  }
+
+}
+
+void runContentHash (oatpp::zlib::Format format, const oatpp::String& original) {
+
+  using oatpp::zlib::HashAlgorithm;
+
+  const v_uint64 expectedCrc = crc32(0L, (const Bytef *) original->data(), (uInt) original->size());
+  const v_uint64 expectedAdler = adler32(1L, (const Bytef *) original->data(), (uInt) original->size());
+  const v_uint64 expectedXX = oatpp::zlib::XXHash64::hash(original->data(), original->size());
+
+  for (auto algorithm : {HashAlgorithm::CRC32, HashAlgorithm::ADLER32, HashAlgorithm::XXHASH64}) {
+    for (v_buff_size threshold : {0, 100}) {
+      for (v_int32 e : {7, 2048}) {
+
+        oatpp::data::buffer::IOBuffer buffer;
+        oatpp::data::stream::BufferInputStream inStream(original);
+        oatpp::data::stream::BufferOutputStream outEncoded;
+
+        oatpp::zlib::DeflateEncoder encoder(e, format);
+        encoder.setInputCoalescing(threshold);
+        encoder.setContentHash(algorithm);
+        oatpp::data::stream::transfer(&inStream, &outEncoded, 0, buffer.getData(), buffer.getSize(), &encoder);
+
+        switch(algorithm) {
+          case HashAlgorithm::CRC32: OATPP_ASSERT(encoder.getContentHash() == expectedCrc); break;
+          case HashAlgorithm::ADLER32: OATPP_ASSERT(encoder.getContentHash() == expectedAdler); break;
+          default: OATPP_ASSERT(encoder.getContentHash() == expectedXX); break;
+        }
+        OATPP_ASSERT(encoder.getContentSize() == (v_int64) original->size());
+
+        oatpp::data::stream::BufferInputStream inEncoded(outEncoded.toString());
+        oatpp::data::stream::BufferOutputStream outStream;
+        oatpp::zlib::DeflateDecoder decoder(2048, format);
+        oatpp::data::stream::transfer(&inEncoded, &outStream, 0, buffer.getData(), buffer.getSize(), &decoder);
+        OATPP_ASSERT(outStream.toString() == original);
+
+      }
+    }
+  }
+
+  oatpp::zlib::DeflateEncoder encoder(2048, format);
+  encoder.setContentHash(HashAlgorithm::XXHASH64);
+  data::buffer::InlineReadData dataIn(original->data(), original->size());
+  data::buffer::InlineReadData dataOut;
+  while(encoder.iterate(dataIn, dataOut) == oatpp::data::buffer::Processor::Error::FLUSH_DATA_OUT) {
+    dataOut.setEof();
+  }
+
+  /* hash can't be changed once the input is processed */
+  bool thrown = false;
+  try {
+    encoder.setContentHash(HashAlgorithm::CRC32);
+  } catch (const std::runtime_error&) {
+    thrown = true;
+  }
+  OATPP_ASSERT(thrown);
+
+  data::buffer::InlineReadData end(nullptr, 0);
+  while(encoder.iterate(end, dataOut) == oatpp::data::buffer::Processor::Error::FLUSH_DATA_OUT) {
+    dataOut.setEof();
+  }
+
+  char etag[48];
+  std::snprintf(etag, sizeof(etag), "W/\"%016llx-%lld\"", (unsigned long long) expectedXX, (long long) original->size());
+  OATPP_ASSERT(encoder.getETag() == etag);
+
+  {
+    /* no hash - no ETag, the size alone doesn't identify the content */
+    oatpp::data::buffer::IOBuffer buffer;
+    oatpp::data::stream::BufferInputStream inStream(original);
+    oatpp::data::stream::BufferOutputStream outEncoded;
+    oatpp::zlib::DeflateEncoder plain(2048, format);
+    oatpp::data::stream::transfer(&inStream, &outEncoded, 0, buffer.getData(), buffer.getSize(), &plain);
+    OATPP_ASSERT(plain.getContentSize() == (v_int64) original->size());
+    OATPP_ASSERT(plain.getETag() == nullptr);
+  }
+
+}
+
+void runPassThroughPipeline (oatpp::zlib::Format format) {
+
+  for (v_int32 p = 1; p <= 64; p++) {
+
+    oatpp::String original(1024);
+    oatpp::utils::Random::randomBytes((p_char8)original->data(), original->size());
+
+    oatpp::data::stream::BufferInputStream inStream(original);
+    oatpp::data::stream::BufferOutputStream outStream;
+
+    oatpp::zlib::DeflateEncoder encoder(p, format);
+    oatpp::zlib::PassThroughProcessor passThrough(p);
+    oatpp::zlib::DeflateDecoder decoder(p, format);
+
+    oatpp::data::buffer::ProcessingPipeline pipeline({
+                                                       &encoder,
+                                                       &passThrough,
+                                                       &decoder
+                                                     });
+
+    oatpp::data::buffer::IOBuffer buffer;
+    oatpp::data::stream::transfer(&inStream, &outStream, 0, buffer.getData(), buffer.getSize(), &pipeline);
+
+    auto check = outStream.toString();
+
+    if (check != original) {
+      OATPP_LOGd("TEST", "Error. p={}", p);
+    }
+
+    OATPP_ASSERT(check == original);
+
+  }
+
+}
+
 }
 
 void DeflateTest::onRun() {
 
+  {
+    using oatpp::zlib::PassThroughEncoderProvider;
+    OATPP_ASSERT(PassThroughEncoderProvider::isAccepted("gzip", "gzip, deflate, br"));
+    OATPP_ASSERT(PassThroughEncoderProvider::isAccepted("gzip", "deflate;q=0.5, GZIP;q=0.8"));
+    OATPP_ASSERT(PassThroughEncoderProvider::isAccepted("gzip", "*"));
+    OATPP_ASSERT(!PassThroughEncoderProvider::isAccepted("gzip", "gzip;q=0, *"));
+    OATPP_ASSERT(!PassThroughEncoderProvider::isAccepted("gzip", "deflate"));
+    OATPP_ASSERT(!PassThroughEncoderProvider::isAccepted("gzip", ""));
+    OATPP_ASSERT(!PassThroughEncoderProvider::isAccepted("gzip", "gzip ; q = 0"));
+    OATPP_ASSERT(!PassThroughEncoderProvider::isAccepted("gzip", "gzip;foo=1;Q=0.000"));
+    OATPP_ASSERT(PassThroughEncoderProvider::isAccepted("gzip", "gzip;foq=0"));
+    OATPP_ASSERT(PassThroughEncoderProvider::isAccepted("gzip", "gzip;level=0;q=1"));
+  }
+
   {
     oatpp::test::PerformanceChecker timer("Deflate");
-    runCompressor(false);
+    runCompressor(oatpp::zlib::Format::ZLIB);
   }
 
   {
     oatpp::test::PerformanceChecker timer("Gzip");
-    runCompressor(true);
+    runCompressor(oatpp::zlib::Format::GZIP);
+  }
+
+  {
+    oatpp::test::PerformanceChecker timer("Raw Deflate");
+    runCompressor(oatpp::zlib::Format::RAW);
   }
 
   {
     oatpp::test::PerformanceChecker timer("Deflate - pipeline");
-    runCompressorPipeline(false);
+    runCompressorPipeline(oatpp::zlib::Format::ZLIB);
   }
 
   {
     oatpp::test::PerformanceChecker timer("Gzip - pipeline");
-    runCompressorPipeline(true);
+    runCompressorPipeline(oatpp::zlib::Format::GZIP);
+  }
+
+  {
+    oatpp::test::PerformanceChecker timer("Raw Deflate - pipeline");
+    runCompressorPipeline(oatpp::zlib::Format::RAW);
+  }
+
+  {
+    oatpp::test::PerformanceChecker timer("Pass-through - pipeline");
+    runPassThroughPipeline(oatpp::zlib::Format::ZLIB);
+    runPassThroughPipeline(oatpp::zlib::Format::GZIP);
+  }
+
+  runFlush(0);
+  runFlush(1024);
+
+  {
+    oatpp::String original(64 * 1024);
+    oatpp::utils::Random::randomBytes((p_char8)original->data(), original->size());
+    oatpp::test::PerformanceChecker timer("Output ring");
+    runOutputRing(oatpp::zlib::Format::ZLIB, original);
+    runOutputRing(oatpp::zlib::Format::GZIP, original);
+  }
+
+  {
+    oatpp::test::PerformanceChecker timer("Adaptive buffer size");
+    runAdaptiveBufferSize(oatpp::zlib::Format::ZLIB);
+    runAdaptiveBufferSize(oatpp::zlib::Format::GZIP);
+  }
+
+  {
+    auto original = generateMixedContent();
+    oatpp::test::PerformanceChecker timer("Vectored output");
+    runVectored(oatpp::zlib::Format::ZLIB, original);
+    runVectored(oatpp::zlib::Format::GZIP, original);
+  }
+
+  {
+
+    auto original = generateMixedContent();
+
+    {
+      oatpp::test::PerformanceChecker timer("Tiny chunks");
+      runInputCoalescing(oatpp::zlib::Format::ZLIB, original, 0);
+    }
+
+    {
+      oatpp::test::PerformanceChecker timer("Tiny chunks - coalesced");
+      runInputCoalescing(oatpp::zlib::Format::ZLIB, original, 4096);
+    }
+
+    runInputCoalescing(oatpp::zlib::Format::GZIP, original, 100);
+
+  }
+
+  {
+    auto original = generateMixedContent();
+    runContentHash(oatpp::zlib::Format::ZLIB, original);
+    runContentHash(oatpp::zlib::Format::GZIP, original);
+    runContentHash(oatpp::zlib::Format::RAW, original);
+  }
+
+  {
+    oatpp::test::PerformanceChecker timer("Adaptive strategy - mixed content");
+    auto original = generateMixedContent();
+    runAdaptiveStrategy(oatpp::zlib::Format::ZLIB, original);
+    runAdaptiveStrategy(oatpp::zlib::Format::GZIP, original);
+    runAdaptiveStrategyRandom(oatpp::zlib::Format::ZLIB);
+    runAdaptiveStrategyRandom(oatpp::zlib::Format::RAW);
   }
 
 }
@@ -0,0 +1,220 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#include "GzipStitcherTest.hpp"
+
+#include "oatpp-zlib/GzipStitcher.hpp"
+#include "oatpp/utils/Random.hpp"
+#include "oatpp/data/stream/BufferStream.hpp"
+
+#include "oatpp-test/Checker.hpp"
+
+#include <cstring>
+
+namespace oatpp { namespace test { namespace zlib {
+
+namespace {
+
+oatpp::String generatePage(const std::string& title, v_int32 rowsCount) {
+  std::string page = "<h1>" + title + "</h1>\n<table>\n";
+  for(v_int32 i = 0; i < rowsCount; i ++) {
+    page += "<tr><td class=\"item\">item " + std::to_string(i) + "</td><td class=\"price\">" + std::to_string(i * 37 % 1000) + "</td></tr>\n";
+  }
+  page += "</table>\n";
+  return page;
+}
+
+oatpp::String encode(const oatpp::String& data) {
+  oatpp::data::stream::BufferInputStream inStream(data);
+  oatpp::data::stream::BufferOutputStream outStream;
+  oatpp::data::buffer::IOBuffer buffer;
+  oatpp::zlib::DeflateEncoder encoder(4096, oatpp::zlib::Format::GZIP);
+  oatpp::data::stream::transfer(&inStream, &outStream, 0, buffer.getData(), buffer.getSize(), &encoder);
+  return outStream.toString();
+}
+
+/* decode feeding input in chunks of chunkSize. Returns nullptr on error */
+oatpp::String decode(const oatpp::String& data, oatpp::zlib::Format format, v_buff_size chunkSize) {
+
+  oatpp::zlib::DeflateDecoder decoder(1024, format);
+  oatpp::data::stream::BufferOutputStream outStream;
+
+  v_buff_size pos = 0;
+
+  while(true) {
+
+    data::buffer::InlineReadData dataIn;
+    v_buff_size size = std::min<v_buff_size>(chunkSize, data->size() - pos);
+    if(size > 0) {
+      dataIn.set(data->data() + pos, size);
+      pos += size;
+    } else {
+      dataIn.set(nullptr, 0);
+    }
+
+    data::buffer::InlineReadData dataOut;
+    v_int32 res;
+    while((res = decoder.iterate(dataIn, dataOut)) == oatpp::data::buffer::Processor::Error::FLUSH_DATA_OUT) {
+      outStream.writeSimple(dataOut.currBufferPtr, dataOut.bytesLeft);
+      dataOut.setEof();
+    }
+
+    if(res == oatpp::data::buffer::Processor::Error::FINISHED) {
+      return outStream.toString();
+    }
+
+    if(res != oatpp::data::buffer::Processor::Error::PROVIDE_DATA_IN) {
+      return nullptr;
+    }
+
+  }
+
+}
+
+/* check that data is one valid gzip member with plain zlib */
+bool isSingleMember(const oatpp::String& data, const oatpp::String& expected) {
+
+  std::unique_ptr<v_char8[]> out(new v_char8[expected->size() + 1]);
+
+  z_stream zStream;
+  zStream.zalloc = Z_NULL;
+  zStream.zfree = Z_NULL;
+  zStream.opaque = Z_NULL;
+  zStream.next_in = (Bytef *) data->data();
+  zStream.avail_in = (uInt) data->size();
+  if(inflateInit2(&zStream, 15 | 16) != Z_OK) {
+    return false;
+  }
+
+  zStream.next_out = out.get();
+  zStream.avail_out = (uInt) expected->size() + 1;
+  int res = inflate(&zStream, Z_FINISH);
+  bool result = res == Z_STREAM_END && zStream.avail_in == 0 &&
+                zStream.total_out == expected->size() &&
+                std::memcmp(out.get(), expected->data(), expected->size()) == 0;
+
+  inflateEnd(&zStream);
+  return result;
+
+}
+
+void testStitching() {
+
+  auto header = oatpp::zlib::GzipFragment::compress(generatePage("Header", 100));
+  auto footer = oatpp::zlib::GzipFragment::compress(generatePage("Footer", 50));
+  auto empty = oatpp::zlib::GzipFragment::compress("");
+
+  OATPP_ASSERT(header->size == (v_int64) generatePage("Header", 100)->size());
+  OATPP_ASSERT(empty->size == 0);
+
+  oatpp::zlib::GzipStitcher stitcher;
+
+  for(v_int32 i = 0; i < 3; i ++) {
+
+    oatpp::String user = "<p>Hello user " + std::to_string(i) + "!</p>\n";
+    oatpp::String random(1000);
+    oatpp::utils::Random::randomBytes((p_char8) random->data(), random->size());
+
+    stitcher.append(header);
+    stitcher.appendDynamic(user);
+    stitcher.append(empty);
+    stitcher.appendDynamic(random);
+    stitcher.appendDynamic("");
+    stitcher.append(footer);
+    auto stitched = stitcher.finish();
+
+    oatpp::String expected = *generatePage("Header", 100) + *user + *random + *generatePage("Footer", 50);
+
+    OATPP_ASSERT(isSingleMember(stitched, expected));
+    for(v_buff_size chunkSize : {1, 7, 4096}) {
+      OATPP_ASSERT(decode(stitched, oatpp::zlib::Format::GZIP, chunkSize) == expected);
+    }
+
+  }
+
+  /* nothing appended - valid empty stream */
+  auto stitched = stitcher.finish();
+  OATPP_ASSERT(isSingleMember(stitched, ""));
+  OATPP_ASSERT(decode(stitched, oatpp::zlib::Format::GZIP, 4096) == "");
+
+}
+
+void testMultiMember() {
+
+  auto first = generatePage("First", 300);
+  auto second = generatePage("Second", 10);
+
+  oatpp::String members = *encode(first) + *encode("") + *encode(second);
+  oatpp::String expected = *first + *second;
+
+  for(v_buff_size chunkSize : {1, 7, 4096, 1024 * 1024}) {
+    OATPP_ASSERT(decode(members, oatpp::zlib::Format::GZIP, chunkSize) == expected);
+  }
+
+  /* truncated last member */
+  oatpp::String truncated = members->substr(0, members->size() - 3);
+  OATPP_ASSERT(decode(truncated, oatpp::zlib::Format::GZIP, 4096) == nullptr);
+
+  /* garbage after a member */
+  oatpp::String garbage = *encode(first) + "garbage";
+  OATPP_ASSERT(decode(garbage, oatpp::zlib::Format::GZIP, 4096) == nullptr);
+
+}
+
+}
+
+void GzipStitcherTest::onRun() {
+
+  testStitching();
+  testMultiMember();
+
+  const v_int32 pagesCount = 500;
+
+  auto header = generatePage("Header", 400);
+  auto footer = generatePage("Footer", 400);
+
+  {
+    oatpp::test::PerformanceChecker timer("Templated pages - full compression");
+    for(v_int32 i = 0; i < pagesCount; i ++) {
+      oatpp::String page = *header + "<p>Hello user " + std::to_string(i) + "!</p>\n" + *footer;
+      OATPP_ASSERT(encode(page)->size() > 0);
+    }
+  }
+
+  {
+    oatpp::test::PerformanceChecker timer("Templated pages - stitched");
+    auto headerFragment = oatpp::zlib::GzipFragment::compress(header);
+    auto footerFragment = oatpp::zlib::GzipFragment::compress(footer);
+    oatpp::zlib::GzipStitcher stitcher;
+    for(v_int32 i = 0; i < pagesCount; i ++) {
+      stitcher.append(headerFragment);
+      stitcher.appendDynamic("<p>Hello user " + std::to_string(i) + "!</p>\n");
+      stitcher.append(footerFragment);
+      OATPP_ASSERT(stitcher.finish()->size() > 0);
+    }
+  }
+
+}
+
+}}}
@@ -0,0 +1,193 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#include "InflateBackDecoderTest.hpp"
+
+#include "oatpp-zlib/InflateBackDecoder.hpp"
+#include "oatpp/utils/Random.hpp"
+#include "oatpp/data/stream/BufferStream.hpp"
+
+#include "oatpp-test/Checker.hpp"
+
+namespace oatpp { namespace test { namespace zlib {
+
+namespace {
+
+oatpp::String generateContent(v_buff_size size) {
+  oatpp::data::stream::BufferOutputStream stream;
+  v_int64 counter = 0;
+  v_char8 random[256];
+  while(stream.getCurrentPosition() < size) {
+    auto line = "uploaded record " + std::to_string(counter ++ % 211) + "\n";
+    stream.writeSimple(line.data(), (v_buff_size) line.size());
+    if(counter % 50 == 0) {
+      oatpp::utils::Random::randomBytes(random, sizeof(random));
+      stream.writeSimple(random, sizeof(random));
+    }
+  }
+  return stream.toString();
+}
+
+oatpp::String encode(const oatpp::String& data, oatpp::zlib::Format format) {
+  oatpp::data::stream::BufferInputStream inStream(data);
+  oatpp::data::stream::BufferOutputStream outStream;
+  oatpp::data::buffer::IOBuffer buffer;
+  oatpp::zlib::DeflateEncoder encoder(4096, format);
+  oatpp::data::stream::transfer(&inStream, &outStream, 0, buffer.getData(), buffer.getSize(), &encoder);
+  return outStream.toString();
+}
+
+oatpp::String encodeGzipWithHeader(const oatpp::String& data) {
+
+  z_stream zStream;
+  zStream.zalloc = Z_NULL;
+  zStream.zfree = Z_NULL;
+  zStream.opaque = Z_NULL;
+  OATPP_ASSERT(deflateInit2(&zStream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 | 16, 8, Z_DEFAULT_STRATEGY) == Z_OK);
+
+  v_char8 extra[] = {'A', 'B', 3, 0, 1, 2, 3};
+  gz_header header = {};
+  header.extra = extra;
+  header.extra_len = sizeof(extra);
+  header.name = (Bytef*) "upload.txt";
+  header.comment = (Bytef*) "comment";
+  header.hcrc = 1;
+  OATPP_ASSERT(deflateSetHeader(&zStream, &header) == Z_OK);
+
+  std::string result(deflateBound(&zStream, (uLong) data->size()) + 1024, '\0');
+  zStream.next_in = (Bytef*) data->data();
+  zStream.avail_in = (uInt) data->size();
+  zStream.next_out = (Bytef*) &result[0];
+  zStream.avail_out = (uInt) result.size();
+  OATPP_ASSERT(deflate(&zStream, Z_FINISH) == Z_STREAM_END);
+  result.resize(zStream.total_out);
+  deflateEnd(&zStream);
+
+  return oatpp::String(std::move(result));
+
+}
+
+v_io_size decode(oatpp::zlib::InflateBackDecoder& decoder, const oatpp::String& encoded, oatpp::String& result) {
+  oatpp::data::stream::BufferInputStream inStream(encoded);
+  oatpp::data::stream::BufferOutputStream outStream;
+  auto res = decoder.decode(&inStream, &outStream);
+  result = outStream.toString();
+  return res;
+}
+
+void runFormat(oatpp::zlib::Format format, const oatpp::String& original) {
+
+  auto encoded = encode(original, format);
+
+  for(v_buff_size inputSize : {1, 7, 1024, 16 * 1024}) {
+    oatpp::zlib::InflateBackDecoder decoder(format, inputSize);
+    oatpp::String result;
+    auto res = decode(decoder, encoded, result);
+    OATPP_ASSERT(res == (v_io_size) original->size());
+    OATPP_ASSERT(result == original);
+  }
+
+  oatpp::zlib::InflateBackDecoder decoder(format);
+
+  /* decoder is reusable */
+  for(v_int32 i = 0; i < 2; i ++) {
+    oatpp::String result;
+    OATPP_ASSERT(decode(decoder, encoded, result) == (v_io_size) original->size());
+    OATPP_ASSERT(result == original);
+  }
+
+  /* truncated stream */
+  {
+    oatpp::String result;
+    auto truncated = oatpp::String(encoded->data(), encoded->size() - 5);
+    OATPP_ASSERT(decode(decoder, truncated, result) == oatpp::zlib::InflateBackDecoder::ERROR_FORMAT);
+  }
+
+  /* broken checksum */
+  if(format != oatpp::zlib::Format::RAW) {
+    std::string broken = *encoded;
+    broken[broken.size() - (format == oatpp::zlib::Format::GZIP ? 8 : 1)] ^= 0x55;
+    oatpp::String result;
+    OATPP_ASSERT(decode(decoder, oatpp::String(broken), result) == oatpp::zlib::InflateBackDecoder::ERROR_CHECKSUM);
+    OATPP_ASSERT(result == original);
+  }
+
+  /* data after the end of stream - next member for gzip, error otherwise */
+  {
+    auto second = encode(oatpp::String("second member"), format);
+    oatpp::String result;
+    auto res = decode(decoder, oatpp::String(*encoded + *second), result);
+    if(format == oatpp::zlib::Format::GZIP) {
+      OATPP_ASSERT(res == (v_io_size) original->size() + 13);
+      OATPP_ASSERT(result == oatpp::String(*original + "second member"));
+    } else {
+      OATPP_ASSERT(res == oatpp::zlib::InflateBackDecoder::ERROR_FORMAT);
+    }
+  }
+
+  {
+    oatpp::String result;
+    auto res = decode(decoder, oatpp::String(*encoded + "trailing garbage"), result);
+    OATPP_ASSERT(res == oatpp::zlib::InflateBackDecoder::ERROR_FORMAT);
+  }
+
+  /* garbage */
+  {
+    oatpp::String garbage(1024);
+    oatpp::utils::Random::randomBytes((p_char8) garbage->data(), garbage->size());
+    garbage->data()[0] = 0x1f;
+    oatpp::String result;
+    OATPP_ASSERT(decode(decoder, garbage, result) < 0);
+  }
+
+}
+
+}
+
+void InflateBackDecoderTest::onRun() {
+
+  auto original = generateContent(1024 * 1024);
+
+  runFormat(oatpp::zlib::Format::ZLIB, original);
+  runFormat(oatpp::zlib::Format::GZIP, original);
+  runFormat(oatpp::zlib::Format::RAW, original);
+
+  {
+    /* gzip header with extra field, name, comment and header crc */
+    oatpp::zlib::InflateBackDecoder decoder(oatpp::zlib::Format::GZIP, 3);
+    oatpp::String result;
+    OATPP_ASSERT(decode(decoder, encodeGzipWithHeader(original), result) == (v_io_size) original->size());
+    OATPP_ASSERT(result == original);
+  }
+
+  {
+    oatpp::zlib::InflateBackDecoder decoder(oatpp::zlib::Format::GZIP);
+    oatpp::String result;
+    OATPP_ASSERT(decode(decoder, encode(oatpp::String(""), oatpp::zlib::Format::GZIP), result) == 0);
+    OATPP_ASSERT(result == "");
+  }
+
+}
+
+}}}
@@ -0,0 +1,175 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#include "OverlappedTransferTest.hpp"
+
+#include "oatpp-zlib/OverlappedTransfer.hpp"
+#include "oatpp-zlib/Processor.hpp"
+#include "oatpp/utils/Random.hpp"
+#include "oatpp/data/stream/BufferStream.hpp"
+
+#include "oatpp/async/Executor.hpp"
+
+namespace oatpp { namespace test { namespace zlib {
+
+namespace {
+
+/* every other write is pending - returns RETRY_WRITE together with an action */
+class PendingWriter : public oatpp::data::stream::WriteCallback {
+private:
+  oatpp::data::stream::BufferOutputStream m_stream;
+  bool m_pending = false;
+public:
+
+  v_io_size write(const void* data, v_buff_size count, oatpp::async::Action& action) override {
+    m_pending = !m_pending;
+    if(m_pending) {
+      action = oatpp::async::Action::createActionByType(oatpp::async::Action::TYPE_REPEAT);
+      return oatpp::IOError::RETRY_WRITE;
+    }
+    if(count > 256) {
+      count = 256;
+    }
+    return m_stream.writeSimple(data, count);
+  }
+
+  oatpp::String toString() {
+    return m_stream.toString();
+  }
+
+};
+
+/* counts input consumed by the processor while dataOut is still pending */
+class AheadCounter : public oatpp::data::buffer::Processor {
+private:
+  std::shared_ptr<oatpp::data::buffer::Processor> m_processor;
+  v_int64 m_consumedAhead = 0;
+public:
+
+  AheadCounter(const std::shared_ptr<oatpp::data::buffer::Processor>& processor)
+    : m_processor(processor)
+  {}
+
+  v_io_size suggestInputStreamReadSize() override {
+    return m_processor->suggestInputStreamReadSize();
+  }
+
+  v_int32 iterate(oatpp::data::buffer::InlineReadData& dataIn, oatpp::data::buffer::InlineReadData& dataOut) override {
+    bool outPending = dataOut.bytesLeft > 0;
+    v_buff_size inSize = dataIn.bytesLeft;
+    v_int32 res = m_processor->iterate(dataIn, dataOut);
+    if(outPending) {
+      m_consumedAhead += inSize - dataIn.bytesLeft;
+    }
+    return res;
+  }
+
+  v_int64 getConsumedAhead() {
+    return m_consumedAhead;
+  }
+
+};
+
+oatpp::String decode(const oatpp::String& data) {
+  oatpp::data::stream::BufferInputStream inStream(data);
+  oatpp::data::stream::BufferOutputStream outStream;
+  oatpp::data::buffer::IOBuffer buffer;
+  oatpp::zlib::DeflateDecoder decoder(1024, oatpp::zlib::Format::GZIP);
+  oatpp::data::stream::transfer(&inStream, &outStream, 0, buffer.getData(), buffer.getSize(), &decoder);
+  return outStream.toString();
+}
+
+class TestCoroutine : public oatpp::async::Coroutine<TestCoroutine> {
+private:
+  v_int32 m_bufferCount;
+  v_buff_size m_transferSize;
+private:
+  oatpp::String m_original;
+  oatpp::data::stream::BufferInputStream m_inStream;
+  std::shared_ptr<PendingWriter> m_writer;
+  std::shared_ptr<AheadCounter> m_counter;
+public:
+
+  TestCoroutine(v_int32 bufferCount, v_buff_size transferSize)
+    : m_bufferCount(bufferCount)
+    , m_transferSize(transferSize)
+    , m_original(64 * 1024)
+    , m_inStream(m_original)
+  {}
+
+  Action act() {
+
+    oatpp::utils::Random::randomBytes((p_char8)m_original->data(), m_original->size());
+
+    auto encoder = std::make_shared<oatpp::zlib::DeflateEncoder>(1024, oatpp::zlib::Format::GZIP);
+    encoder->setOutputBufferCount(m_bufferCount);
+
+    m_writer = std::make_shared<PendingWriter>();
+    m_counter = std::make_shared<AheadCounter>(encoder);
+
+    auto buffer = std::make_shared<oatpp::data::buffer::IOBuffer>();
+    return oatpp::zlib::transferOverlappedAsync(&m_inStream, m_writer, m_transferSize, buffer, m_counter)
+           .next(yieldTo(&TestCoroutine::check));
+
+  }
+
+  Action check() {
+
+    auto check = decode(m_writer->toString());
+    if(m_transferSize > 0) {
+      OATPP_ASSERT(check == m_original->substr(0, m_transferSize));
+    } else {
+      OATPP_ASSERT(check == m_original);
+    }
+
+    /* with several output buffers the encoder compresses while writes are pending */
+    if(m_bufferCount > 1) {
+      OATPP_ASSERT(m_counter->getConsumedAhead() > 0);
+    } else {
+      OATPP_ASSERT(m_counter->getConsumedAhead() == 0);
+    }
+
+    return finish();
+
+  }
+
+};
+
+}
+
+void OverlappedTransferTest::onRun() {
+
+  oatpp::async::Executor executor;
+
+  executor.execute<TestCoroutine>(1, 0);
+  executor.execute<TestCoroutine>(4, 0);
+  executor.execute<TestCoroutine>(4, 48000);
+
+  executor.waitTasksFinished();
+  executor.stop();
+  executor.join();
+
+}
+
+}}}
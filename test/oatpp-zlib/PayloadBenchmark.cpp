@@ -0,0 +1,154 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#include "PayloadBenchmark.hpp"
+
+#include "oatpp-zlib/InflateBackDecoder.hpp"
+#include "oatpp-zlib/Processor.hpp"
+#include "oatpp/utils/Random.hpp"
+#include "oatpp/data/stream/BufferStream.hpp"
+
+#include "oatpp-test/Checker.hpp"
+
+namespace oatpp { namespace test { namespace zlib {
+
+namespace {
+
+void runLargePayload (oatpp::zlib::Format format, const oatpp::String& original,
+                      oatpp::zlib::HashAlgorithm hashAlgorithm = oatpp::zlib::HashAlgorithm::NONE)
+{
+
+  oatpp::data::buffer::IOBuffer buffer;
+
+  oatpp::data::stream::BufferInputStream inStream(original);
+  oatpp::data::stream::BufferOutputStream outEncoded;
+
+  oatpp::zlib::DeflateEncoder encoder(64 * 1024, format, Z_BEST_SPEED);
+  encoder.setContentHash(hashAlgorithm);
+  oatpp::data::stream::transfer(&inStream, &outEncoded, 0, buffer.getData(), buffer.getSize(), &encoder);
+
+  oatpp::data::stream::BufferInputStream inEncoded(outEncoded.toString());
+  oatpp::data::stream::BufferOutputStream outStream;
+
+  oatpp::zlib::DeflateDecoder decoder(64 * 1024, format);
+  oatpp::data::stream::transfer(&inEncoded, &outStream, 0, buffer.getData(), buffer.getSize(), &decoder);
+
+  OATPP_ASSERT(outStream.toString() == original);
+
+}
+
+oatpp::String generateContent(v_buff_size size) {
+  oatpp::data::stream::BufferOutputStream stream;
+  v_int64 counter = 0;
+  v_char8 random[256];
+  while(stream.getCurrentPosition() < size) {
+    auto line = "uploaded record " + std::to_string(counter ++ % 211) + "\n";
+    stream.writeSimple(line.data(), (v_buff_size) line.size());
+    if(counter % 50 == 0) {
+      oatpp::utils::Random::randomBytes(random, sizeof(random));
+      stream.writeSimple(random, sizeof(random));
+    }
+  }
+  return stream.toString();
+}
+
+oatpp::String encode(const oatpp::String& data, oatpp::zlib::Format format) {
+  oatpp::data::stream::BufferInputStream inStream(data);
+  oatpp::data::stream::BufferOutputStream outStream;
+  oatpp::data::buffer::IOBuffer buffer;
+  oatpp::zlib::DeflateEncoder encoder(4096, format);
+  oatpp::data::stream::transfer(&inStream, &outStream, 0, buffer.getData(), buffer.getSize(), &encoder);
+  return outStream.toString();
+}
+
+}
+
+void PayloadBenchmark::onRun() {
+
+  {
+
+    /* checksum overhead is best seen on large payloads with fast compression */
+    oatpp::String original(32 * 1024 * 1024);
+    oatpp::utils::Random::randomBytes((p_char8)original->data(), 1024);
+    for(v_buff_size i = 1024; i < (v_buff_size) original->size(); i ++) {
+      original->data()[i] = original->data()[i % 1024] ^ (char) (i / 4096);
+    }
+
+    {
+      oatpp::test::PerformanceChecker timer("Deflate - 32MB");
+      runLargePayload(oatpp::zlib::Format::ZLIB, original);
+    }
+
+    {
+      oatpp::test::PerformanceChecker timer("Gzip - 32MB");
+      runLargePayload(oatpp::zlib::Format::GZIP, original);
+    }
+
+    {
+      oatpp::test::PerformanceChecker timer("Raw Deflate - 32MB");
+      runLargePayload(oatpp::zlib::Format::RAW, original);
+    }
+
+    {
+      oatpp::test::PerformanceChecker timer("Raw Deflate - 32MB - separate xxHash64 pass");
+      OATPP_ASSERT(oatpp::zlib::XXHash64::hash(original->data(), original->size()) != 0);
+      runLargePayload(oatpp::zlib::Format::RAW, original);
+    }
+
+    {
+      oatpp::test::PerformanceChecker timer("Raw Deflate - 32MB - fused xxHash64");
+      runLargePayload(oatpp::zlib::Format::RAW, original, oatpp::zlib::HashAlgorithm::XXHASH64);
+    }
+
+  }
+
+  {
+
+    auto large = generateContent(32 * 1024 * 1024);
+    auto encoded = encode(large, oatpp::zlib::Format::GZIP);
+
+    {
+      oatpp::test::PerformanceChecker timer("Gunzip 32MB - DeflateDecoder");
+      oatpp::data::stream::BufferInputStream inStream(encoded);
+      oatpp::data::stream::BufferOutputStream outStream;
+      oatpp::data::buffer::IOBuffer buffer;
+      oatpp::zlib::DeflateDecoder decoder(2048, oatpp::zlib::Format::GZIP);
+      oatpp::data::stream::transfer(&inStream, &outStream, 0, buffer.getData(), buffer.getSize(), &decoder);
+      OATPP_ASSERT(outStream.getCurrentPosition() == (v_buff_size) large->size());
+    }
+
+    {
+      oatpp::test::PerformanceChecker timer("Gunzip 32MB - InflateBackDecoder");
+      oatpp::data::stream::BufferInputStream inStream(encoded);
+      oatpp::data::stream::BufferOutputStream outStream;
+      oatpp::zlib::InflateBackDecoder decoder(oatpp::zlib::Format::GZIP);
+      OATPP_ASSERT(decoder.decode(&inStream, &outStream) == (v_io_size) large->size());
+      OATPP_ASSERT(outStream.getCurrentPosition() == (v_buff_size) large->size());
+    }
+
+  }
+
+}
+
+}}}
@@ -0,0 +1,176 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#include "PerMessageDeflateTest.hpp"
+
+#include "oatpp-zlib/PerMessageDeflate.hpp"
+#include "oatpp/utils/Random.hpp"
+
+#include "oatpp-test/Checker.hpp"
+
+namespace oatpp { namespace test { namespace zlib {
+
+namespace {
+
+typedef oatpp::zlib::PerMessageDeflate PerMessageDeflate;
+
+oatpp::String generateMessage(v_int32 id, v_buff_size size) {
+  std::string result = "{\"id\": " + std::to_string(id) + ", \"items\": [";
+  v_int32 counter = 0;
+  while((v_buff_size) result.size() < size) {
+    result += "{\"name\": \"item-" + std::to_string(counter) + "\", \"value\": " + std::to_string(counter * 7 % 13) + "},";
+    counter ++;
+  }
+  result.resize(size);
+  return result;
+}
+
+void testNegotiation() {
+
+  PerMessageDeflate::Config preferred;
+  PerMessageDeflate::Config agreed;
+
+  OATPP_ASSERT(PerMessageDeflate::negotiate("permessage-deflate; client_max_window_bits", preferred, agreed));
+  OATPP_ASSERT(agreed.toString() == "permessage-deflate");
+
+  preferred.clientMaxWindowBits = 10;
+  preferred.serverMaxWindowBits = 12;
+  preferred.serverNoContextTakeover = true;
+
+  OATPP_ASSERT(PerMessageDeflate::negotiate("x-webkit-deflate-frame, permessage-deflate; client_max_window_bits", preferred, agreed));
+  OATPP_ASSERT(agreed.toString() == "permessage-deflate; server_no_context_takeover; server_max_window_bits=12; client_max_window_bits=10");
+
+  OATPP_ASSERT(PerMessageDeflate::negotiate("permessage-deflate; server_max_window_bits=\"11\"", preferred, agreed));
+  OATPP_ASSERT(agreed.toString() == "permessage-deflate; server_no_context_takeover; server_max_window_bits=11");
+
+  OATPP_ASSERT(!PerMessageDeflate::negotiate("permessage-deflate; server_max_window_bits=8", preferred, agreed));
+  OATPP_ASSERT(!PerMessageDeflate::negotiate("permessage-deflate; server_max_window_bits=16", preferred, agreed));
+  OATPP_ASSERT(!PerMessageDeflate::negotiate("permessage-deflate; unknown_param", preferred, agreed));
+  OATPP_ASSERT(!PerMessageDeflate::negotiate("x-webkit-deflate-frame", preferred, agreed));
+
+  OATPP_ASSERT(PerMessageDeflate::parseResponse("permessage-deflate; client_no_context_takeover; client_max_window_bits=9", agreed));
+  OATPP_ASSERT(agreed.clientNoContextTakeover);
+  OATPP_ASSERT(agreed.clientMaxWindowBits == 9);
+  OATPP_ASSERT(!PerMessageDeflate::parseResponse("permessage-deflate; client_max_window_bits=8", agreed));
+
+}
+
+void runMessages(const PerMessageDeflate::Config& config, v_buff_size messageSize) {
+
+  PerMessageDeflate server(config, true);
+  PerMessageDeflate client(config, false);
+
+  v_buff_size compressedTotal = 0;
+  v_buff_size originalTotal = 0;
+
+  for(v_int32 i = 0; i < 100; i ++) {
+
+    auto message = generateMessage(i, messageSize);
+    oatpp::data::buffer::InlineWriteData compressed;
+    oatpp::data::buffer::InlineWriteData decompressed;
+
+    /* server -> client */
+    OATPP_ASSERT(server.deflateMessage(message->data(), message->size(), compressed) == Z_OK);
+    OATPP_ASSERT(client.inflateMessage(compressed.currBufferPtr, compressed.bytesLeft, decompressed) == Z_OK);
+    OATPP_ASSERT(std::string((const char*) decompressed.currBufferPtr, decompressed.bytesLeft) == *message);
+
+    compressedTotal += compressed.bytesLeft;
+    originalTotal += message->size();
+
+    /* client -> server */
+    OATPP_ASSERT(client.deflateMessage(message->data(), message->size(), compressed) == Z_OK);
+    OATPP_ASSERT(server.inflateMessage(compressed.currBufferPtr, compressed.bytesLeft, decompressed) == Z_OK);
+    OATPP_ASSERT(std::string((const char*) decompressed.currBufferPtr, decompressed.bytesLeft) == *message);
+
+  }
+
+  if(messageSize >= 1024) {
+    OATPP_ASSERT(compressedTotal < originalTotal / 2);
+  }
+
+}
+
+void testLimits() {
+
+  PerMessageDeflate::Config config;
+  PerMessageDeflate server(config, true);
+  PerMessageDeflate client(config, false, Z_DEFAULT_COMPRESSION, 1024 * 64);
+
+  oatpp::data::buffer::InlineWriteData compressed;
+  oatpp::data::buffer::InlineWriteData decompressed;
+
+  auto message = generateMessage(0, 1024 * 64);
+  OATPP_ASSERT(server.deflateMessage(message->data(), message->size(), compressed) == Z_OK);
+  OATPP_ASSERT(client.inflateMessage(compressed.currBufferPtr, compressed.bytesLeft, decompressed) == Z_OK);
+  OATPP_ASSERT(decompressed.bytesLeft == 1024 * 64);
+
+  message = generateMessage(0, 1024 * 64 + 1);
+  OATPP_ASSERT(server.deflateMessage(message->data(), message->size(), compressed) == Z_OK);
+  OATPP_ASSERT(client.inflateMessage(compressed.currBufferPtr, compressed.bytesLeft, decompressed) == PerMessageDeflate::ERROR_MESSAGE_TOO_LARGE);
+
+  /* empty message */
+  OATPP_ASSERT(server.deflateMessage(nullptr, 0, compressed) == Z_OK);
+  OATPP_ASSERT(compressed.bytesLeft == 1);
+  OATPP_ASSERT(client.inflateMessage(compressed.currBufferPtr, compressed.bytesLeft, decompressed) == Z_OK);
+  OATPP_ASSERT(decompressed.bytesLeft == 0);
+
+  /* corrupted message */
+  v_char8 garbage[16];
+  oatpp::utils::Random::randomBytes(garbage, 16);
+  garbage[0] = 0xff;
+  OATPP_ASSERT(client.inflateMessage(garbage, 16, decompressed) == PerMessageDeflate::ERROR_UNKNOWN);
+
+}
+
+}
+
+void PerMessageDeflateTest::onRun() {
+
+  testNegotiation();
+  testLimits();
+
+  PerMessageDeflate::Config config;
+
+  {
+    oatpp::test::PerformanceChecker timer("Context takeover");
+    runMessages(config, 16);
+    runMessages(config, 1024);
+    runMessages(config, 1024 * 64);
+  }
+
+  config.serverNoContextTakeover = true;
+  config.clientNoContextTakeover = true;
+  config.serverMaxWindowBits = 9;
+  config.clientMaxWindowBits = 10;
+
+  {
+    oatpp::test::PerformanceChecker timer("No context takeover");
+    runMessages(config, 16);
+    runMessages(config, 1024);
+    runMessages(config, 1024 * 64);
+  }
+
+}
+
+}}}
@@ -0,0 +1,301 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#include "ResponseCacheTest.hpp"
+
+#include "oatpp-zlib/ResponseCache.hpp"
+#include "oatpp-zlib/EncoderProvider.hpp"
+#include "oatpp-zlib/Processor.hpp"
+#include "oatpp/utils/Random.hpp"
+#include "oatpp/data/stream/BufferStream.hpp"
+
+#include "oatpp-test/Checker.hpp"
+
+#include <thread>
+
+namespace oatpp { namespace test { namespace zlib {
+
+namespace {
+
+oatpp::String generateText(v_buff_size size, v_int64 seed) {
+  oatpp::data::stream::BufferOutputStream stream;
+  v_int64 counter = seed;
+  while(stream.getCurrentPosition() < size) {
+    auto line = "item " + std::to_string(counter ++ % 89) + " - catalog page content\n";
+    stream.writeSimple(line.data(), (v_buff_size) line.size());
+  }
+  return stream.toString();
+}
+
+oatpp::String decode(const oatpp::String& encoded, bool gzip) {
+  oatpp::data::stream::BufferInputStream inStream(encoded);
+  oatpp::data::stream::BufferOutputStream outStream;
+  oatpp::data::buffer::IOBuffer buffer;
+  oatpp::zlib::DeflateDecoder decoder(2048, gzip);
+  oatpp::data::stream::transfer(&inStream, &outStream, 0, buffer.getData(), buffer.getSize(), &decoder);
+  return outStream.toString();
+}
+
+oatpp::String encodeWithProvider(const std::shared_ptr<web::protocol::http::encoding::EncoderProvider>& provider,
+                                 const oatpp::String& body)
+{
+  oatpp::data::stream::BufferInputStream inStream(body);
+  oatpp::data::stream::BufferOutputStream outStream;
+  oatpp::data::buffer::IOBuffer buffer;
+  auto res = oatpp::data::stream::transfer(&inStream, &outStream, 0, buffer.getData(), buffer.getSize(), provider->getProcessor());
+  OATPP_ASSERT(res == (v_io_size) body->size());
+  return outStream.toString();
+}
+
+void runLru() {
+
+  /* one shard - eviction order is predictable */
+  oatpp::zlib::ResponseCache cache(4 * 1024, 1);
+
+  oatpp::String data(1000);
+  OATPP_ASSERT(cache.put("a", "gzip", data));
+  OATPP_ASSERT(cache.put("b", "gzip", data));
+  OATPP_ASSERT(cache.put("c", "gzip", data));
+
+  OATPP_ASSERT(cache.get("a", "gzip") == data); // "a" is the most recent now
+  OATPP_ASSERT(cache.get("a", "deflate") == nullptr);
+
+  cache.put("d", "gzip", data); // evicts "b"
+
+  OATPP_ASSERT(cache.get("b", "gzip") == nullptr);
+  OATPP_ASSERT(cache.get("a", "gzip") != nullptr);
+  OATPP_ASSERT(cache.get("c", "gzip") != nullptr);
+  OATPP_ASSERT(cache.get("d", "gzip") != nullptr);
+
+  OATPP_ASSERT(!cache.put("big", "gzip", oatpp::String(8 * 1024))); // doesn't fit - not cached
+  OATPP_ASSERT(cache.get("big", "gzip") == nullptr);
+
+  OATPP_ASSERT(cache.remove("c", "gzip"));
+  OATPP_ASSERT(!cache.remove("c", "gzip"));
+
+  auto stats = cache.getStats();
+  OATPP_ASSERT(stats.hits == 4);
+  OATPP_ASSERT(stats.misses == 3);
+  OATPP_ASSERT(stats.insertions == 4);
+  OATPP_ASSERT(stats.evictions == 1);
+  OATPP_ASSERT(stats.entriesCount == 2);
+  OATPP_ASSERT(stats.size <= cache.getMaxSize());
+
+  cache.clear();
+  OATPP_ASSERT(cache.getStats().entriesCount == 0);
+  OATPP_ASSERT(cache.getStats().size == 0);
+
+}
+
+void runContentCheck() {
+
+  oatpp::zlib::ResponseCache cache(64 * 1024, 1);
+
+  oatpp::String content = "some content";
+  oatpp::String data = "compressed";
+
+  OATPP_ASSERT(cache.put("key", "gzip", data, content));
+  OATPP_ASSERT(cache.get("key", "gzip", content) == data);
+  OATPP_ASSERT(cache.get("key", "gzip", oatpp::String("other content")) == nullptr);
+  OATPP_ASSERT(cache.get("key", "gzip") == nullptr);
+
+  /* content counts towards the entry size */
+  OATPP_ASSERT(!cache.put("key", "gzip", data, oatpp::String(cache.getMaxEntrySize())));
+
+  /* admission - second offer of the same key */
+  OATPP_ASSERT(!cache.admit("key", "gzip"));
+  OATPP_ASSERT(!cache.admit("key", "deflate"));
+  OATPP_ASSERT(cache.admit("key", "gzip"));
+  OATPP_ASSERT(!cache.admit("key", "gzip"));
+
+  /* older candidates are forgotten */
+  OATPP_ASSERT(!cache.admit("old", "gzip"));
+  for(v_int64 i = 0; i < oatpp::zlib::ResponseCache::CANDIDATES_PER_SHARD; i ++) {
+    cache.admit(oatpp::String("key-" + std::to_string(i)), "gzip");
+  }
+  OATPP_ASSERT(!cache.admit("old", "gzip"));
+
+}
+
+void runCachingProvider(bool gzip) {
+
+  std::shared_ptr<web::protocol::http::encoding::EncoderProvider> provider;
+  if(gzip) {
+    provider = std::make_shared<oatpp::zlib::GzipEncoderProvider>();
+  } else {
+    provider = std::make_shared<oatpp::zlib::DeflateEncoderProvider>();
+  }
+
+  auto cache = std::make_shared<oatpp::zlib::ResponseCache>(16 * 1024 * 1024);
+  auto cachingProvider = std::make_shared<oatpp::zlib::CachingEncoderProvider>(provider, cache, 256 * 1024);
+
+  OATPP_ASSERT(cachingProvider->getEncodingName() == provider->getEncodingName());
+
+  auto body = generateText(100 * 1024, 0);
+
+  /* cached when seen the second time */
+  auto first = encodeWithProvider(cachingProvider, body);
+  OATPP_ASSERT(decode(first, gzip) == body);
+  OATPP_ASSERT(cache->getStats().entriesCount == 0);
+  OATPP_ASSERT(encodeWithProvider(cachingProvider, body) == first);
+  OATPP_ASSERT(cache->getStats().entriesCount == 1);
+
+  {
+    oatpp::test::PerformanceChecker timer("Response cache - 100 hits");
+    for(v_int32 i = 0; i < 100; i ++) {
+      auto encoded = encodeWithProvider(cachingProvider, body);
+      OATPP_ASSERT(encoded == first);
+    }
+  }
+
+  {
+    oatpp::test::PerformanceChecker timer("No cache - 100 compressions");
+    for(v_int32 i = 0; i < 100; i ++) {
+      encodeWithProvider(provider, body);
+    }
+  }
+
+  auto stats = cache->getStats();
+  OATPP_ASSERT(stats.misses == 2);
+  OATPP_ASSERT(stats.hits == 100);
+  OATPP_ASSERT(stats.entriesCount == 1);
+
+  /* different body - different content key, one-off body is not cached */
+  auto other = generateText(100 * 1024, 1);
+  OATPP_ASSERT(decode(encodeWithProvider(cachingProvider, other), gzip) == other);
+  OATPP_ASSERT(cache->getStats().misses == 3);
+  OATPP_ASSERT(cache->getStats().entriesCount == 1);
+
+  /* content key collision - an entry with the key of `other` but different content is not served */
+  auto otherKey = oatpp::zlib::ResponseCache::getContentKey(other->data(), other->size());
+  OATPP_ASSERT(cache->put(otherKey, provider->getEncodingName(), first, body));
+  OATPP_ASSERT(decode(encodeWithProvider(cachingProvider, other), gzip) == other);
+  OATPP_ASSERT(cache->getStats().misses == 4);
+
+  /* empty body */
+  OATPP_ASSERT(decode(encodeWithProvider(cachingProvider, oatpp::String("")), gzip) == "");
+  OATPP_ASSERT(decode(encodeWithProvider(cachingProvider, oatpp::String("")), gzip) == "");
+
+  /* too large to cache - streamed */
+  auto large = generateText(1024 * 1024, 2);
+  OATPP_ASSERT(decode(encodeWithProvider(cachingProvider, large), gzip) == large);
+  OATPP_ASSERT(decode(encodeWithProvider(cachingProvider, large), gzip) == large);
+  OATPP_ASSERT(cache->getStats().entriesCount == 3);
+
+  {
+    /* larger than the cache entry - streamed even though it is within maxBodySize */
+    auto smallCache = std::make_shared<oatpp::zlib::ResponseCache>(64 * 1024, 16);
+    auto smallProvider = std::make_shared<oatpp::zlib::CachingEncoderProvider>(provider, smallCache, 256 * 1024);
+    auto page = generateText(8 * 1024, 3);
+    OATPP_ASSERT(decode(encodeWithProvider(smallProvider, page), gzip) == page);
+    OATPP_ASSERT(decode(encodeWithProvider(smallProvider, page), gzip) == page);
+    OATPP_ASSERT(smallCache->getStats().misses == 0);
+    OATPP_ASSERT(smallCache->getStats().entriesCount == 0);
+  }
+
+  {
+    /* collected bodies fit into the entry with the key - incompressible data near the limit */
+    auto smallCache = std::make_shared<oatpp::zlib::ResponseCache>(64 * 1024, 1);
+    auto smallProvider = std::make_shared<oatpp::zlib::CachingEncoderProvider>(provider, smallCache, 256 * 1024);
+    v_int64 collected = 0;
+    for(v_buff_size size = smallCache->getMaxEntrySize() / 2; size > smallCache->getMaxEntrySize() / 2 - 1024; size -= 16) {
+      oatpp::String page(size);
+      oatpp::utils::Random::randomBytes((p_char8) page->data(), size);
+      auto before = smallCache->getStats();
+      OATPP_ASSERT(decode(encodeWithProvider(smallProvider, page), gzip) == page);
+      OATPP_ASSERT(decode(encodeWithProvider(smallProvider, page), gzip) == page);
+      auto after = smallCache->getStats();
+      if(after.misses > before.misses) {
+        OATPP_ASSERT(after.insertions == before.insertions + 1);
+        collected ++;
+      }
+    }
+    OATPP_ASSERT(collected > 0);
+  }
+
+}
+
+void runConcurrent() {
+
+  auto cache = std::make_shared<oatpp::zlib::ResponseCache>(256 * 1024, 8);
+  auto provider = std::make_shared<oatpp::zlib::GzipEncoderProvider>();
+
+  std::vector<oatpp::String> bodies;
+  for(v_int32 i = 0; i < 64; i ++) {
+    bodies.push_back(generateText(4 * 1024, i));
+  }
+
+  std::vector<std::thread> threads;
+  for(v_int32 t = 0; t < 8; t ++) {
+    threads.push_back(std::thread([cache, provider, &bodies, t]{
+      for(v_int32 i = 0; i < 500; i ++) {
+        v_int32 index = (i * 7 + t) % (v_int32) bodies.size();
+        auto key = "page-" + std::to_string(index);
+        auto encoded = cache->getOrCompress(key, provider, [&bodies, index]{ return bodies[index]; });
+        OATPP_ASSERT(decode(encoded, true) == bodies[index]);
+      }
+    }));
+  }
+
+  for(auto& thread : threads) {
+    thread.join();
+  }
+
+  auto stats = cache->getStats();
+  OATPP_ASSERT(stats.hits + stats.misses == 8 * 500);
+  OATPP_ASSERT(stats.hits > stats.misses);
+  OATPP_ASSERT(stats.size <= cache->getMaxSize());
+
+}
+
+}
+
+void ResponseCacheTest::onRun() {
+
+  {
+    OATPP_ASSERT(oatpp::zlib::XXHash64::hash("", 0) == 0xef46db3751d8e999ULL);
+    OATPP_ASSERT(oatpp::zlib::XXHash64::hash("abc", 3) == 0x44bc2cf5ad770999ULL);
+
+    const char* text = "Nobody inspects the spammish repetition";
+    oatpp::zlib::XXHash64 hash;
+    for(v_buff_size i = 0; i < 39; i += 5) {
+      hash.update(text + i, std::min<v_buff_size>(5, 39 - i));
+    }
+    OATPP_ASSERT(hash.digest() == 0xfbcea83c8a378bf1ULL);
+    OATPP_ASSERT(oatpp::zlib::XXHash64::hash(text, 39) == 0xfbcea83c8a378bf1ULL);
+  }
+
+  runLru();
+  runContentCheck();
+  runCachingProvider(false);
+  runCachingProvider(true);
+
+  {
+    oatpp::test::PerformanceChecker timer("Response cache - concurrent");
+    runConcurrent();
+  }
+
+}
+
+}}}
@@ -0,0 +1,193 @@
+/***************************************************************************
+ *
+ * Project         _____    __   ____   _      _
+ *                (  _  )  /__\ (_  _)_| |_  _| |_
+ *                 )(_)(  /(__)\  )( (_   _)(_   _)
+ *                (_____)(__)(__)(__)  |_|    |_|
+ *
+ *
+ * Copyright 2018-present, Leonid Stryzhevskyi <lganzzzo@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************************/
+
+#include "TranscoderTest.hpp"
+
+#include "oatpp-zlib/Processor.hpp"
+#include "oatpp-zlib/Transcoder.hpp"
+#include "oatpp/utils/Random.hpp"
+#include "oatpp/data/stream/BufferStream.hpp"
+
+#include "oatpp-test/Checker.hpp"
+
+namespace oatpp { namespace test { namespace zlib {
+
+namespace {
+
+oatpp::String generateText(v_buff_size size) {
+  oatpp::data::stream::BufferOutputStream stream;
+  v_int64 counter = 0;
+  while(stream.getCurrentPosition() < size) {
+    auto line = "line " + std::to_string(counter ++ % 97) + " - some compressible text\n";
+    stream.writeSimple(line.data(), (v_buff_size) line.size());
+  }
+  return stream.toString();
+}
+
+void runTranscoderPipeline(const oatpp::String& original, bool gzipIn, bool gzipOut) {
+
+  for (v_int32 t = 1; t <= 64; t++) {
+
+    oatpp::data::stream::BufferInputStream inStream(original);
+    oatpp::data::stream::BufferOutputStream outStream;
+
+    oatpp::zlib::DeflateEncoder encoder(t, gzipIn);
+    oatpp::zlib::Transcoder transcoder(t, gzipOut);
+    oatpp::zlib::DeflateDecoder decoder(t, gzipOut);
+
+    oatpp::data::buffer::ProcessingPipeline pipeline({
+                                                       &encoder,
+                                                       &transcoder,
+                                                       &decoder
+                                                     });
+
+    oatpp::data::buffer::IOBuffer buffer;
+    auto res = oatpp::data::stream::transfer(&inStream, &outStream, 0, buffer.getData(), buffer.getSize(), &pipeline);
+
+    auto check = outStream.toString();
+
+    if (check != original) {
+      OATPP_LOGd("TEST", "Error. t={}, gzipIn={}, gzipOut={}, res={}", t, gzipIn, gzipOut, res);
+    }
+
+    OATPP_ASSERT(check == original);
+
+  }
+
+}
+
+oatpp::String encode(const oatpp::String& data, bool gzip) {
+  oatpp::data::stream::BufferInputStream inStream(data);
+  oatpp::data::stream::BufferOutputStream outStream;
+  oatpp::data::buffer::IOBuffer buffer;
+  oatpp::zlib::DeflateEncoder encoder(1024, gzip);
+  oatpp::data::stream::transfer(&inStream, &outStream, 0, buffer.getData(), buffer.getSize(), &encoder);
+  return outStream.toString();
+}
+
+/* transcode feeding input in chunks of chunkSize. Returns nullptr on error */
+oatpp::String transcode(const oatpp::String& data, bool gzipOut, v_buff_size chunkSize) {
+
+  oatpp::zlib::Transcoder transcoder(1024, gzipOut);
+  oatpp::data::stream::BufferOutputStream outStream;
+
+  v_buff_size pos = 0;
+
+  while(true) {
+
+    data::buffer::InlineReadData dataIn;
+    v_buff_size size = std::min<v_buff_size>(chunkSize, data->size() - pos);
+    if(size > 0) {
+      dataIn.set(data->data() + pos, size);
+      pos += size;
+    } else {
+      dataIn.set(nullptr, 0);
+    }
+
+    data::buffer::InlineReadData dataOut;
+    v_int32 res;
+    while((res = transcoder.iterate(dataIn, dataOut)) == oatpp::data::buffer::Processor::Error::FLUSH_DATA_OUT) {
+      outStream.writeSimple(dataOut.currBufferPtr, dataOut.bytesLeft);
+      dataOut.setEof();
+    }
+
+    if(res == oatpp::data::buffer::Processor::Error::FINISHED) {
+      return outStream.toString();
+    }
+
+    if(res != oatpp::data::buffer::Processor::Error::PROVIDE_DATA_IN) {
+      return nullptr;
+    }
+
+  }
+
+}
+
+oatpp::String corrupt(const oatpp::String& data, v_buff_size pos) {
+  std::string result = *data;
+  result[pos] ^= 0x01;
+  return result;
+}
+
+void runInvalidInput(const oatpp::String& original) {
+
+  auto gzip = encode(original, true);
+  auto zlib = encode(original, false);
+  auto gzipSize = (v_buff_size) gzip->size();
+  auto zlibSize = (v_buff_size) zlib->size();
+
+  for(v_buff_size chunkSize : {1, 7, 4096}) {
+
+    OATPP_ASSERT(transcode(gzip, false, chunkSize) == zlib);
+    OATPP_ASSERT(transcode(zlib, true, chunkSize) != nullptr);
+
+    /* corrupt CRC-32, ISIZE, Adler-32 */
+    OATPP_ASSERT(transcode(corrupt(gzip, gzipSize - 8), false, chunkSize) == nullptr);
+    OATPP_ASSERT(transcode(corrupt(gzip, gzipSize - 1), false, chunkSize) == nullptr);
+    OATPP_ASSERT(transcode(corrupt(zlib, zlibSize - 1), true, chunkSize) == nullptr);
+
+    /* truncated trailer, truncated payload */
+    OATPP_ASSERT(transcode(gzip->substr(0, gzipSize - 3), false, chunkSize) == nullptr);
+    OATPP_ASSERT(transcode(zlib->substr(0, zlibSize / 2), true, chunkSize) == nullptr);
+
+    /* several gzip members, trailing garbage */
+    OATPP_ASSERT(transcode(*gzip + *gzip, false, chunkSize) == nullptr);
+    OATPP_ASSERT(transcode(*zlib + "garbage", true, chunkSize) == nullptr);
+
+  }
+
+}
+
+}
+
+void TranscoderTest::onRun() {
+
+  oatpp::String random(1024 * 16);
+  oatpp::utils::Random::randomBytes((p_char8)random->data(), random->size());
+
+  auto text = generateText(1024 * 16);
+
+  {
+    oatpp::test::PerformanceChecker timer("Gzip -> Deflate");
+    runTranscoderPipeline(random, true, false);
+    runTranscoderPipeline(text, true, false);
+  }
+
+  {
+    oatpp::test::PerformanceChecker timer("Deflate -> Gzip");
+    runTranscoderPipeline(random, false, true);
+    runTranscoderPipeline(text, false, true);
+  }
+
+  {
+    oatpp::test::PerformanceChecker timer("Gzip -> Gzip");
+    runTranscoderPipeline(text, true, true);
+  }
+
+  runInvalidInput(text);
+  runInvalidInput("");
+
+}
+
+}}}
@@ -0,0 +1,29 @@
+
+#include "./PayloadBenchmark.hpp"
+
+#include <iostream>
+
+namespace {
+
+void runBenchmarks() {
+  OATPP_RUN_TEST(oatpp::test::zlib::PayloadBenchmark);
+}
+
+}
+
+int main() {
+
+  oatpp::Environment::init();
+
+  runBenchmarks();
+
+  std::cout << "\nEnvironment:\n";
+  std::cout << "objectsCount = " << oatpp::Environment::getObjectsCount() << "\n";
+  std::cout << "objectsCreated = " << oatpp::Environment::getObjectsCreated() << "\n\n";
+
+  OATPP_ASSERT(oatpp::Environment::getObjectsCount() == 0);
+
+  oatpp::Environment::destroy();
+
+  return 0;
+}
@@ -1,6 +1,13 @@
 
 #include "./DeflateTest.hpp"
 #include "./DeflateAsyncTest.hpp"
+#include "./TranscoderTest.hpp"
+#include "./PerMessageDeflateTest.hpp"
+#include "./ResponseCacheTest.hpp"
+#include "./ArchiveTest.hpp"
+#include "./InflateBackDecoderTest.hpp"
+#include "./GzipStitcherTest.hpp"
+#include "./OverlappedTransferTest.hpp"
 
 #include <iostream>
 
@@ -9,6 +16,13 @@ namespace {
 void runTests() {
   OATPP_RUN_TEST(oatpp::test::zlib::DeflateTest);
   OATPP_RUN_TEST(oatpp::test::zlib::DeflateAsyncTest);
+  OATPP_RUN_TEST(oatpp::test::zlib::TranscoderTest);
+  OATPP_RUN_TEST(oatpp::test::zlib::PerMessageDeflateTest);
+  OATPP_RUN_TEST(oatpp::test::zlib::ResponseCacheTest);
+  OATPP_RUN_TEST(oatpp::test::zlib::ArchiveTest);
+  OATPP_RUN_TEST(oatpp::test::zlib::InflateBackDecoderTest);
+  OATPP_RUN_TEST(oatpp::test::zlib::GzipStitcherTest);
+  OATPP_RUN_TEST(oatpp::test::zlib::OverlappedTransferTest);
 }
 
 }